@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define TAM_BUFFER_SAIDA 65536 // Tamanho do bloco usado para imprimir as pistas
+
 // ----------------------------------------------------------------------------
 // ESTRUTURAS DE DADOS
 // ----------------------------------------------------------------------------
@@ -161,20 +163,29 @@ Sala* criarSala(const char* nome, const char* pista) {
 }
 
 /**
- * @brief Libera recursivamente toda a memória alocada para o mapa da mansão.
+ * @brief Libera toda a memória alocada para o mapa da mansão, sem recursão.
  *
- * Percorre a árvore em pós-ordem, liberando primeiro os filhos e depois o próprio nó,
- * para evitar vazamento de memória.
+ * Enquanto a sala atual tiver filho à esquerda, faz uma rotação à direita
+ * (o filho esquerdo sobe e a sala atual vira seu filho direito). Quando não
+ * há sub-árvore esquerda, a sala é liberada e o percurso segue pela direita.
+ * Assim, mesmo mapas com milhões de níveis são liberados em tempo linear e
+ * com memória extra constante, sem risco de estourar a pilha.
  *
- * @param sala O nó (cômodo) atual a ser liberado.
+ * @param sala A raiz do mapa a ser liberado.
  */
 void liberarMapa(Sala* sala) {
-    if (sala == NULL) {
-        return;
+    while (sala != NULL) {
+        if (sala->esquerda != NULL) {
+            Sala* esquerda = sala->esquerda;
+            sala->esquerda = esquerda->direita;
+            esquerda->direita = sala;
+            sala = esquerda;
+        } else {
+            Sala* direita = sala->direita;
+            free(sala);
+            sala = direita;
+        }
     }
-    liberarMapa(sala->esquerda);
-    liberarMapa(sala->direita);
-    free(sala);
 }
 
 // ----------------------------------------------------------------------------
@@ -184,72 +195,114 @@ void liberarMapa(Sala* sala) {
 /**
  * @brief Insere uma nova pista na Árvore Binária de Busca (BST) de forma ordenada.
  *
- * Esta função é recursiva. Ela compara a nova pista com a pista do nó atual
- * para decidir se a inserção deve ocorrer à esquerda ou à direita. Se a pista
- * já existir, ela não é inserida novamente.
+ * A descida é feita com um laço: a cada passo a nova pista é comparada com a
+ * pista do nó atual para decidir se o caminho segue à esquerda ou à direita.
+ * Guardamos o endereço do ponteiro que será preenchido, então não é preciso
+ * recursão (importante quando as pistas chegam em ordem e a árvore degenera
+ * em uma lista). Se a pista já existir, ela não é inserida novamente.
  *
- * @param raiz O nó raiz da sub-árvore atual.
+ * @param raiz O nó raiz da BST.
  * @param novaPista A string contendo a pista a ser inserida.
- * @return A nova raiz da sub-árvore após a inserção.
+ * @return A raiz da BST após a inserção.
  */
 PistaNode* inserirPista(PistaNode* raiz, const char* novaPista) {
-    // Caso base: Se a raiz for NULL, cria um novo nó e o retorna
-    if (raiz == NULL) {
-        PistaNode* novoNode = (PistaNode*) malloc(sizeof(PistaNode));
-        if (novoNode == NULL) {
-            printf("Erro: Falha ao alocar memoria para uma pista.\n");
-            exit(1);
+    PistaNode** ligacao = &raiz; // Ponteiro que receberá o novo nó
+
+    while (*ligacao != NULL) {
+        // Compara a nova pista com a pista do nó atual
+        int comparacao = strcmp(novaPista, (*ligacao)->pista);
+
+        if (comparacao < 0) { // Se a nova pista é "menor" (vem antes no alfabeto)
+            ligacao = &(*ligacao)->esquerda;
+        } else if (comparacao > 0) { // Se a nova pista é "maior" (vem depois no alfabeto)
+            ligacao = &(*ligacao)->direita;
+        } else {
+            return raiz; // A pista já existe na árvore, então não faz nada.
         }
-        strcpy(novoNode->pista, novaPista);
-        novoNode->esquerda = NULL;
-        novoNode->direita = NULL;
-        return novoNode;
     }
 
-    // Compara a nova pista com a pista do nó atual
-    int comparacao = strcmp(novaPista, raiz->pista);
-
-    if (comparacao < 0) { // Se a nova pista é "menor" (vem antes no alfabeto)
-        raiz->esquerda = inserirPista(raiz->esquerda, novaPista);
-    } else if (comparacao > 0) { // Se a nova pista é "maior" (vem depois no alfabeto)
-        raiz->direita = inserirPista(raiz->direita, novaPista);
+    PistaNode* novoNode = (PistaNode*) malloc(sizeof(PistaNode));
+    if (novoNode == NULL) {
+        printf("Erro: Falha ao alocar memoria para uma pista.\n");
+        exit(1);
     }
-    // Se comparacao == 0, a pista já existe na árvore, então não faz nada.
+    strcpy(novoNode->pista, novaPista);
+    novoNode->esquerda = NULL;
+    novoNode->direita = NULL;
+    *ligacao = novoNode;
 
-    return raiz; // Retorna a raiz atual (ou a nova raiz se houve inserção na raiz)
+    return raiz;
 }
 
 /**
  * @brief Exibe todas as pistas coletadas em ordem alfabética (percurso Em Ordem).
  *
- * Esta função é recursiva e realiza um percurso Em Ordem (Inorder Traversal)
- * na BST, garantindo que as pistas sejam impressas em ordem crescente.
+ * Usa o percurso de Morris: em vez de recursão ou de uma pilha, cada nó com
+ * sub-árvore esquerda ganha temporariamente um "fio" do seu predecessor até
+ * ele, que é desfeito na segunda passagem. A árvore volta ao estado original
+ * ao final. As linhas são acumuladas em um buffer e enviadas em blocos de
+ * TAM_BUFFER_SAIDA bytes, em vez de um printf por pista.
  *
- * @param raiz O nó raiz da sub-árvore atual.
+ * @param raiz O nó raiz da BST.
  */
 void exibirPistas(PistaNode* raiz) {
-    if (raiz != NULL) {
-        exibirPistas(raiz->esquerda); // Visita a sub-árvore esquerda
-        printf("- %s\n", raiz->pista); // Visita o nó atual (imprime a pista)
-        exibirPistas(raiz->direita);  // Visita a sub-árvore direita
+    static char buffer[TAM_BUFFER_SAIDA];
+    size_t usado = 0;
+    PistaNode* atual = raiz;
+
+    while (atual != NULL) {
+        if (atual->esquerda != NULL) {
+            // Procura o predecessor (nó mais à direita da sub-árvore esquerda)
+            PistaNode* predecessor = atual->esquerda;
+            while (predecessor->direita != NULL && predecessor->direita != atual) {
+                predecessor = predecessor->direita;
+            }
+            if (predecessor->direita == NULL) {
+                predecessor->direita = atual; // Cria o fio e desce à esquerda
+                atual = atual->esquerda;
+                continue;
+            }
+            predecessor->direita = NULL; // Sub-árvore esquerda já visitada: desfaz o fio
+        }
+
+        // Visita o nó atual (acrescenta "- pista\n" ao buffer)
+        size_t tamanho = strlen(atual->pista);
+        if (usado + tamanho + 3 > sizeof(buffer)) {
+            fwrite(buffer, 1, usado, stdout);
+            usado = 0;
+        }
+        buffer[usado++] = '-';
+        buffer[usado++] = ' ';
+        memcpy(buffer + usado, atual->pista, tamanho);
+        usado += tamanho;
+        buffer[usado++] = '\n';
+
+        atual = atual->direita; // Visita a sub-árvore direita
     }
+    fwrite(buffer, 1, usado, stdout);
 }
 
 /**
- * @brief Libera recursivamente toda a memória alocada para a BST de pistas.
+ * @brief Libera toda a memória alocada para a BST de pistas, sem recursão.
  *
- * Realiza um percurso em pós-ordem para liberar todos os nós da BST,
- * prevenindo vazamentos de memória.
+ * Usa a mesma técnica de rotações de liberarMapa(), prevenindo vazamentos
+ * de memória sem depender da profundidade da árvore.
  *
- * @param raiz O nó raiz da sub-árvore atual a ser liberada.
+ * @param raiz O nó raiz da BST a ser liberada.
  */
 void liberarPistas(PistaNode* raiz) {
-    if (raiz == NULL) {
-        return;
+    while (raiz != NULL) {
+        if (raiz->esquerda != NULL) {
+            PistaNode* esquerda = raiz->esquerda;
+            raiz->esquerda = esquerda->direita;
+            esquerda->direita = raiz;
+            raiz = esquerda;
+        } else {
+            PistaNode* direita = raiz->direita;
+            free(raiz);
+            raiz = direita;
+        }
     }
-    liberarPistas(raiz->esquerda);
-    liberarPistas(raiz->direita);
-    free(raiz);
 }
 
 
@@ -1,12 +1,50 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#endif
+
+// Laços paralelos com OpenMP quando compilado com -fopenmp; sequenciais caso contrário
+#ifdef _OPENMP
+#define PARALELO_PARA _Pragma("omp parallel for schedule(static)")
+#define PARALELO_PARA_DINAMICO _Pragma("omp parallel for schedule(dynamic, 1)")
+#else
+#define PARALELO_PARA
+#define PARALELO_PARA_DINAMICO
+#endif
 
 // ----------------------------------------------------------------------------
 // CONSTANTES E ESTRUTURAS DE DADOS
 // ----------------------------------------------------------------------------
 
 #define HASH_SIZE 10 // Define o tamanho da nossa Tabela Hash
+#define MAX_DETETIVES 4 // Máximo de detetives no modo cooperativo
+#define TAM_BUFFER_SAIDA 65536 // Buffer usado para imprimir listas longas de pistas
+#define TOP_K_SUSPEITOS 3 // Tamanho do ranking de suspeitos mais prováveis
+#define PERCENTUAL_SALAS_COM_PISTA 40 // Fração de salas com pista nas mansões geradas
+#define MAGICA_MANSAO "DQM1" // Identifica os arquivos de mansão gerada
+#define MAX_SALAS_MANSAO (INT32_MAX / 2) // Até 2 associações por sala precisam caber no `int` da base
+#define MAX_SUSPEITOS_MANSAO 1000000
+#define SEM_SALA UINT32_MAX // Saída inexistente em um MapaGrafo
+#define TAM_BUFFER_EVENTOS 4096 // Eventos acumulados antes de gravar o registro da sessão
+#define MAGICA_COLUNAR "DQC2" // Identifica os arquivos colunares de análise
+#define SEM_VALOR INT64_MAX // Posição vazia em uma ArvoreMinimos
+#define MAX_SIMBOLOS 254 // Códigos 0-253 são símbolos da tabela de textos
+#define CODIGO_FIM 254 // Fim de um texto codificado
+#define CODIGO_ESCAPE 255 // O próximo byte vai literal
+#define RODADAS_TREINO_SIMBOLOS 5
+#define TAM_AMOSTRA_TEXTOS 65536 // Bytes de texto usados para treinar a tabela
+#define TAM_TEXTO_MAPA 128 // Buffer de decodificação de um nome ou pista
+#define PALAVRAS_POR_BLOCO 8 // Blocos de 512 bits no diretório de rank da árvore sucinta
+#define UNS_POR_AMOSTRA 512 // Um ponto de partida de select a cada 512 bits 1
+#define LIMITE_AMOSTRA_DENSA 65536 // Amostras de select mais longas (em bits) guardam cada posição
+#define MAX_LEITORES_BASE 64 // Sessões (ou threads) lendo a base publicada ao mesmo tempo
+#define INTERVALO_RECARGA_MS 500 // Intervalo entre conferências do arquivo da base
 
 // Estrutura para os cômodos da mansão (Árvore Binária do Mapa)
 typedef struct Sala {
@@ -30,6 +68,311 @@ typedef struct HashNode {
     struct HashNode *next;
 } HashNode;
 
+// Função chamada para cada nó em um percurso em ordem da BST de pistas
+typedef void (*VisitaPista)(PistaNode* node, void* contexto);
+
+// Uma ligação pista -> suspeito com o peso da evidência
+typedef struct AssociacaoPista {
+    const char* pista;
+    const char* suspeito;
+    float peso;
+} AssociacaoPista;
+
+// Índice texto -> id com endereçamento aberto (ids densos a partir de 0)
+typedef struct IndiceTexto {
+    uint32_t capacidade; // Potência de 2
+    int* slots;          // id em cada posição, ou -1 se vazia
+    char** textos;       // Texto de cada id
+    int quantidade;
+} IndiceTexto;
+
+// Base de evidências muitos-para-muitos em formato CSR (linhas = pistas)
+typedef struct BaseEvidencias {
+    IndiceTexto pistas;
+    IndiceTexto suspeitos;
+    int* inicio;    // Ligações da pista p: [inicio[p], inicio[p + 1])
+    int* suspeito;  // Suspeito de cada ligação
+    float* peso;    // Peso de cada ligação
+} BaseEvidencias;
+
+// Formas de mansão do gerador procedural
+enum { FORMA_BALANCEADA, FORMA_ENVIESADA, FORMA_ALEATORIA, NUM_FORMAS_MANSAO };
+static const char* const NOMES_FORMAS_MANSAO[NUM_FORMAS_MANSAO] = { "balanceada", "enviesada", "aleatoria" };
+
+// Mansão gerada em formato compacto: salas numeradas de 0 (Hall) a nSalas - 1.
+// Nomes e pistas são derivados do índice ("Sala 7", "Pista 7", "Suspeito_3").
+typedef struct MansaoGerada {
+    uint32_t nSalas;
+    uint32_t nSuspeitos;
+    uint64_t semente;
+    int forma;
+    int32_t* esquerda; // Índice da sala à esquerda, ou -1
+    int32_t* direita;  // Índice da sala à direita, ou -1
+    int32_t* suspeito; // Suspeito ligado à pista da sala, ou -1 se a sala não tem pista
+} MansaoGerada;
+
+// Cabeçalho do arquivo de mansão (seguido de esquerda[], direita[] e suspeito[])
+typedef struct CabecalhoMansao {
+    char magica[4];
+    uint32_t versao;
+    uint32_t nSalas;
+    uint32_t nSuspeitos;
+    uint32_t forma;
+    uint32_t reservado;
+    uint64_t semente;
+} CabecalhoMansao;
+
+// Tabela de símbolos (1 a 8 bytes) para compactar textos, no estilo do FSST.
+// `ordem[primeiro[b] .. primeiro[b + 1])` são os códigos que começam pelo byte b,
+// do maior para o menor.
+typedef struct TabelaSimbolos {
+    uint32_t nSimbolos;
+    uint8_t tamanho[MAX_SIMBOLOS];
+    char simbolo[MAX_SIMBOLOS][8];
+    uint16_t primeiro[257];
+    uint8_t ordem[MAX_SIMBOLOS];
+} TabelaSimbolos;
+
+// Candidato a símbolo durante o treino da tabela
+typedef struct CandidatoSimbolo {
+    uint64_t bytes; // Até 8 bytes do candidato, completados com zeros
+    uint32_t contagem;
+    uint8_t tamanho;
+} CandidatoSimbolo;
+
+// Mapa geral da mansão (N saídas por sala, ciclos permitidos) em formato CSR.
+// As saídas da sala s são destino[inicio[s] .. inicio[s + 1]); nas salas vindas
+// de árvores, a primeira saída é a esquerda e a segunda a direita.
+// Nomes e pistas são deslocamentos em `textos` (deslocamento 0 = texto vazio).
+typedef struct MapaGrafo {
+    uint32_t nSalas;
+    const uint32_t* inicio;
+    const uint32_t* destino;
+    const uint32_t* nome;
+    const uint32_t* pista;
+    const char* textos;
+    void* memoria; // Bloco único com todos os vetores (NULL se o mapa não é dono deles)
+    const TabelaSimbolos* simbolos; // Se não for NULL, `textos` está codificado (ver textoDoMapa)
+} MapaGrafo;
+
+// Índice de ancestrais da árvore de salas: passeio de Euler + sparse table.
+// tabela[k * tamanhoEuler + i] é a sala mais rasa de euler[i .. i + 2^k); o nível
+// 0 é o próprio passeio. Salas não alcançadas têm primeira = SEM_SALA.
+typedef struct IndiceAncestrais {
+    uint32_t nSalas;
+    uint32_t tamanhoEuler;
+    uint32_t nNiveis;
+    uint32_t* pai;
+    uint32_t* profundidade;
+    uint32_t* primeira; // Primeira ocorrência de cada sala no passeio
+    uint32_t* tabela;
+    uint8_t* logaritmo; // logaritmo[x] = piso(log2(x))
+} IndiceAncestrais;
+
+// Árvore de segmentos de mínimo (iterativa, folhas em nos[folhas + i])
+typedef struct NoMinimo {
+    int64_t valor;
+    uint32_t sala;
+} NoMinimo;
+
+typedef struct ArvoreMinimos {
+    uint32_t folhas;
+    NoMinimo* nos;
+} ArvoreMinimos;
+
+// Pré-ordem das salas alcançáveis, compartilhada pelas sessões de um mapa. Em um
+// mapa-árvore, as salas alcançáveis a partir de s ocupam [posicao[s], posicao[s] +
+// tamanho[s]). Salas não alcançadas têm posicao = SEM_SALA.
+typedef struct OrdemSalas {
+    const MapaGrafo* mapa;
+    IndiceAncestrais* indice;
+    uint32_t nSalas;
+    uint32_t* posicao;
+    uint32_t* tamanho; // Salas na subárvore
+    int arvore; // 0 se há passagens extras (ciclos ou atalhos): dicas por busca em largura
+} OrdemSalas;
+
+// Pistas pendentes de uma sessão
+typedef struct MotorDicas {
+    const OrdemSalas* ordem;
+    uint64_t* pendentes;
+    ArvoreMinimos profundidades; // Profundidade de cada sala pendente, na pré-ordem
+    uint32_t* fila; // Busca em largura (só em mapas com ciclos, alocada na primeira dica)
+    uint32_t* anterior;
+    uint32_t* marca;
+    uint32_t rodada;
+} MotorDicas;
+
+// Árvore binária sucinta: 2 bits por sala em largura (tem esquerda, tem direita),
+// mais o diretório de rank por bloco e amostras para select (~2,2 bits por sala).
+// Uma amostra cujos UNS_POR_AMOSTRA uns cobrem mais de LIMITE_AMOSTRA_DENSA bits
+// (longas sequências de folhas) guarda a posição de cada 1 em `posicoes`; nas
+// demais, select faz uma busca binária em no máximo LIMITE_AMOSTRA_DENSA / 512 + 1 blocos.
+typedef struct ArvoreSucinta {
+    uint32_t nSalas;
+    uint32_t nBlocos;
+    uint32_t nAmostras;
+    uint64_t* bits;
+    uint32_t* rankBloco; // 1s antes de cada bloco (nBlocos + 1 posições)
+    uint32_t* amostraSelect; // Bloco onde está o 1 de ordem k * UNS_POR_AMOSTRA + 1
+    uint32_t* esparsa; // Início da amostra em `posicoes` (SEM_SALA se densa)
+    uint64_t* posicoes;
+    size_t nPosicoes;
+} ArvoreSucinta;
+
+// Tipos de evento do registro de sessões
+enum { EVENTO_INICIO, EVENTO_VISITA, EVENTO_PISTA, EVENTO_ACUSACAO, EVENTO_MAPA, EVENTO_BASE };
+
+// Evento do registro de sessões (16 bytes, gravado em modo de acréscimo).
+// `sessao` é um id aleatório de 64 bits: ids de 32 bits já colidiriam com
+// ~50% de chance a partir de ~77 mil sessões e misturariam as duas na análise.
+// `valor` é o número de salas (início), a sala visitada, a sala da pista
+// coletada ou o suspeito acusado (SEM_SALA se o nome não existe na base).
+// EVENTO_MAPA e EVENTO_BASE trazem em `valor` as assinaturas do mapa e da base
+// de pistas em uso (a da base é gravada de novo quando a sessão adota outra versão),
+// para que salas e suspeitos de mapas e bases diferentes não se misturem na análise.
+typedef struct EventoSessao {
+    uint64_t sessao;
+    uint32_t valor;
+    uint8_t tipo;
+    uint8_t acerto; // Acusação com evidências suficientes
+    uint16_t reservado;
+} EventoSessao;
+
+// Grupo de eventos com o mesmo par de assinaturas na análise (0 = sem assinatura)
+typedef struct GrupoAnalise {
+    uint32_t mapa;
+    uint32_t base;
+    uint64_t sessoes; // Sessões que começaram neste mapa (contadas no grupo do EVENTO_MAPA)
+    uint64_t entradas; // Sessões (ou trechos depois de uma recarga) jogadas com esta base
+    uint64_t acusacoes;
+} GrupoAnalise;
+
+// Salas com pista de um par (mapa, base): um bit por sala. O registro grava cada
+// par uma única vez, em "<registro>.salas" (cabeçalho mapa, base, nSalas, 0 em
+// uint32 seguido dos bits), e o formato colunar traz todos os pares dos registros.
+typedef struct SalasComPista {
+    uint32_t mapa;
+    uint32_t base;
+    uint32_t nSalas;
+    uint64_t* bits;
+} SalasComPista;
+
+typedef struct RegistroSessao {
+    FILE* arquivo;
+    char* caminhoSalas;
+    const MapaGrafo* mapa;
+    uint32_t assinaturaMapa;
+    uint64_t sessao;
+    size_t usados;
+    EventoSessao buffer[TAM_BUFFER_EVENTOS];
+} RegistroSessao;
+
+// Uma versão publicada da base de evidências (imutável depois de publicada)
+typedef struct VersaoBase {
+    BaseEvidencias* base;
+    uint32_t numero;
+    uint64_t aposentadaEm; // Época em que deixou de ser a atual
+    struct VersaoBase* proxima; // Próxima na lista de aposentadas
+} VersaoBase;
+
+// Publicação da base no estilo RCU: leitores pegam a versão atual sem travas e
+// anunciam a época em que o fizeram; versões aposentadas são liberadas quando
+// todos os leitores ativos já anunciaram uma época posterior à aposentadoria.
+typedef struct PublicacaoBase {
+    _Atomic(VersaoBase*) atual;
+    _Atomic uint64_t epoca;
+    _Atomic uint64_t leitores[MAX_LEITORES_BASE]; // Época anunciada por leitor (0 = fora de leitura)
+    atomic_int ocupado[MAX_LEITORES_BASE];
+    VersaoBase* aposentadas; // Só o publicador mexe na lista
+    uint32_t versoes;
+    uint32_t recolhidas;
+    const char* arquivo; // Arquivo acompanhado pela recarga, ou NULL
+    uint32_t assinatura; // hashTexto do último conteúdo lido
+    atomic_int parar;
+    int recargaAtiva;
+#ifndef __STDC_NO_THREADS__
+    thrd_t recarga;
+#endif
+} PublicacaoBase;
+
+// Ranking incremental dos k suspeitos com maior pontuação (heap mínimo)
+typedef struct RankingSuspeitos {
+    const BaseEvidencias* base;
+    double* pontuacao; // Pontuação acumulada de cada suspeito
+    int* posHeap;      // Posição do suspeito no heap, ou -1
+    int* heap;
+    int k;
+    int tamanho;
+    int kPedido;
+    PublicacaoBase* publicacao; // Origem da base, se ela pode ser recarregada
+    int leitor;
+    uint32_t versaoBase;
+    char** registradas; // Pistas registradas (só com publicação), refeitas a cada nova versão
+    int nRegistradas;
+    int capRegistradas;
+} RankingSuspeitos;
+
+
+// ----------------------------------------------------------------------------
+// MANSÃO DO CASO (MONTADA EM TEMPO DE COMPILAÇÃO)
+// ----------------------------------------------------------------------------
+
+// Cada linha descreve uma sala: X(id, nome, pista, sala à esquerda, sala à direita).
+// As macros abaixo transformam esta tabela em um MapaGrafo somente-leitura:
+// ids viram índices, os textos ficam em um único bloco estático e os filhos já
+// saem resolvidos, então o jogo começa sem nenhum malloc para o mapa.
+#define CASO_MANSAO(X) \
+    X(HALL,           "Hall de Entrada", "Um jornal velho sobre a mesa, com a data de 1920.", SALA_DE_JANTAR, BIBLIOTECA) \
+    X(SALA_DE_JANTAR, "Sala de Jantar",  "Um candelabro de prata polido, fora do lugar.",     COZINHA,        NENHUMA) \
+    X(BIBLIOTECA,     "Biblioteca",      "Um livro sobre venenos com uma pagina marcada.",     ESCRITORIO,     JARDIM_SECRETO) \
+    X(COZINHA,        "Cozinha",         "Uma faca de cozinha faltando no conjunto.",          NENHUMA,        NENHUMA) \
+    X(ESCRITORIO,     "Escritorio",      "Uma carta de ameaca enderecada a vitima.",           NENHUMA,        NENHUMA) \
+    X(JARDIM_SECRETO, "Jardim Secreto",  "Pegadas de sapatos caros na lama.",                  NENHUMA,        NENHUMA)
+
+#define CASO_ENUM(id, nome, pista, esq, dir) CASO_##id,
+#define CASO_CAMPOS_TEXTO(id, nome, pista, esq, dir) char nome_##id[sizeof(nome)]; char pista_##id[sizeof(pista)];
+#define CASO_VALORES_TEXTO(id, nome, pista, esq, dir) nome, pista,
+#define CASO_INICIO(id, nome, pista, esq, dir) 2u * CASO_##id,
+#define CASO_DESTINO(id, nome, pista, esq, dir) (uint32_t) CASO_##esq, (uint32_t) CASO_##dir,
+#define CASO_NOME(id, nome, pista, esq, dir) (uint32_t) offsetof(TextosCaso, nome_##id),
+#define CASO_PISTA(id, nome, pista, esq, dir) (uint32_t) offsetof(TextosCaso, pista_##id),
+#define CASO_NENHUMA SEM_SALA
+
+enum { CASO_MANSAO(CASO_ENUM) NUM_SALAS_CASO };
+
+// Bloco de textos: um campo por nome/pista, com o tamanho exato do literal
+typedef struct TextosCaso {
+    char vazio[1];
+    CASO_MANSAO(CASO_CAMPOS_TEXTO)
+} TextosCaso;
+
+static const TextosCaso TEXTOS_CASO = { "", CASO_MANSAO(CASO_VALORES_TEXTO) };
+static const uint32_t INICIO_CASO[] = { CASO_MANSAO(CASO_INICIO) 2u * NUM_SALAS_CASO };
+static const uint32_t DESTINO_CASO[] = { CASO_MANSAO(CASO_DESTINO) };
+static const uint32_t NOME_CASO[] = { CASO_MANSAO(CASO_NOME) };
+static const uint32_t PISTA_CASO[] = { CASO_MANSAO(CASO_PISTA) };
+
+// Mapa do caso, pronto para explorarMapa() (duas saídas por sala: esquerda e direita)
+static const MapaGrafo MAPA_CASO = {
+    NUM_SALAS_CASO, INICIO_CASO, DESTINO_CASO, NOME_CASO, PISTA_CASO, (const char*) &TEXTOS_CASO, NULL, NULL
+};
+
+// Associações do caso: a primeira ligação de cada pista é o suspeito principal
+// (a pista só é coletada no jogo se tiver algum suspeito).
+// Pesos menores indicam evidências circunstanciais que também pesam no ranking.
+static const AssociacaoPista ASSOCIACOES_CASO[] = {
+    { "Um candelabro de prata polido, fora do lugar.", "Mordomo", 1.0f },
+    { "Pegadas de sapatos caros na lama.", "Dama_da_noite", 1.0f },
+    { "Pegadas de sapatos caros na lama.", "Jardineiro", 0.5f },
+    { "Uma faca de cozinha faltando no conjunto.", "Cozinheira", 1.0f },
+    { "Uma faca de cozinha faltando no conjunto.", "Mordomo", 0.5f },
+    { "Uma carta de ameaca enderecada a vitima.", "Dama_da_noite", 1.0f },
+    { "Um livro sobre venenos com uma pagina marcada.", "Mordomo", 1.0f },
+    { "Um livro sobre venenos com uma pagina marcada.", "Cozinheira", 0.5f },
+};
+#define NUM_ASSOCIACOES_CASO ((int) (sizeof(ASSOCIACOES_CASO) / sizeof(ASSOCIACOES_CASO[0])))
+
 
 // ----------------------------------------------------------------------------
 // PROTÓTIPOS DAS FUNÇÕES
@@ -41,65 +384,348 @@ void liberarMapa(Sala* sala);
 
 // Funções da BST de Pistas
 PistaNode* adicionarPista(PistaNode* raiz, const char* novaPista);
+void percorrerEmOrdem(PistaNode* raiz, VisitaPista visitar, void* contexto);
+void escreverPistas(FILE* saida, PistaNode* raiz);
 void exibirPistas(PistaNode* raiz);
 void liberarPistas(PistaNode* raiz);
 
+// Operações em lote sobre a BST de Pistas (modo cooperativo)
+int contarPistas(PistaNode* raiz);
+int listarPistasEmOrdem(PistaNode* raiz, const char* destino[], int pos);
+PistaNode* construirIntervaloBalanceado(const char* pistas[], int inicio, int fim);
+PistaNode* construirPistasBalanceadas(const char* pistas[], int n);
+void linearizarPares(PistaNode* a, PistaNode* b, const char*** va, int* na, const char*** vb, int* nb);
+PistaNode* mesclarPistas(PistaNode* a, PistaNode* b);
+PistaNode* intersectarPistas(PistaNode* a, PistaNode* b);
+
 // Funções da Tabela Hash
 unsigned int hashFunction(const char* str);
 void inserirNaHash(HashNode* tabela[], const char* pista, const char* suspeito);
 const char* encontrarSuspeito(HashNode* tabela[], const char* pista);
+void atualizarSuspeitoNaHash(HashNode* tabela[], const char* pista, const char* suspeito);
 void liberarHash(HashNode* tabela[]);
 
+// Funções da Base de Evidências e do Ranking de Suspeitos
+uint32_t hashTexto(const char* str);
+uint64_t proximoAleatorio(uint64_t* estado);
+char* duplicarTexto(const char* texto);
+void iniciarIndiceTexto(IndiceTexto* indice, int maxTextos);
+int buscarNoIndice(const IndiceTexto* indice, const char* texto);
+int obterIdNoIndice(IndiceTexto* indice, const char* texto);
+void liberarIndiceTexto(IndiceTexto* indice);
+BaseEvidencias* criarBaseEvidencias(const AssociacaoPista associacoes[], int n);
+void liberarBaseEvidencias(BaseEvidencias* base);
+RankingSuspeitos* criarRanking(const BaseEvidencias* base, int k);
+void prepararRanking(RankingSuspeitos* ranking, const BaseEvidencias* base);
+int rankingMenor(const RankingSuspeitos* ranking, int a, int b);
+void trocarNoHeap(RankingSuspeitos* ranking, int i, int j);
+void descerNoHeap(RankingSuspeitos* ranking, int i);
+void subirNoHeap(RankingSuspeitos* ranking, int i);
+void atualizarRanking(RankingSuspeitos* ranking, int suspeito);
+int somarEvidencia(RankingSuspeitos* ranking, const char* pista);
+int registrarEvidencia(RankingSuspeitos* ranking, const char* pista);
+int obterRanking(const RankingSuspeitos* ranking, int destino[]);
+void exibirRanking(const RankingSuspeitos* ranking);
+void liberarRanking(RankingSuspeitos* ranking);
+
+// Funções do Mapa em Grafo (CSR) e Conjuntos de Bits
+uint64_t* criarConjuntoBits(uint32_t n);
+int testarBit(const uint64_t* bits, uint32_t i);
+void marcarBit(uint64_t* bits, uint32_t i);
+MapaGrafo* alocarMapaGrafo(uint32_t nSalas, size_t nSaidas, size_t tamTextos,
+                           uint32_t** inicio, uint32_t** destino, uint32_t** nome, uint32_t** pista, char** textos);
+MapaGrafo* mapaDeArvore(const Sala* raiz);
+MapaGrafo* mapaDeMansaoGerada(const MansaoGerada* mansao, uint32_t extras);
+void liberarMapaGrafo(MapaGrafo* mapa);
+uint32_t percorrerLargura(const MapaGrafo* mapa, uint32_t origem, uint64_t* visitadas);
+const char* suspeitoPrincipal(const BaseEvidencias* base, const char* pista);
+int coletarPista(uint32_t sala, const char* pista, PistaNode** bstPistas, HashNode* tabelaHash[],
+                 RankingSuspeitos* ranking, uint64_t* pistasColetadas);
+void explorarMapa(const MapaGrafo* mapa, uint32_t origem, PistaNode** bstPistas, HashNode* tabelaHash[],
+                  RankingSuspeitos* ranking, uint64_t* pistasColetadas, RegistroSessao* registro,
+                  OrdemSalas** ordem);
+int executarMansaoArquivo(int argc, char* argv[], const char* caminhoRegistro);
+
+// Índice de ancestrais (LCA, profundidade e caminhos entre salas)
+IndiceAncestrais* criarIndiceAncestrais(const MapaGrafo* mapa, uint32_t raiz);
+uint32_t ancestralComum(const IndiceAncestrais* indice, uint32_t a, uint32_t b);
+int ehAncestral(const IndiceAncestrais* indice, uint32_t ancestral, uint32_t sala);
+int estaNoCaminho(const IndiceAncestrais* indice, uint32_t a, uint32_t b, uint32_t sala);
+uint32_t distanciaSalas(const IndiceAncestrais* indice, uint32_t a, uint32_t b);
+uint32_t caminhoEntreSalas(const IndiceAncestrais* indice, uint32_t a, uint32_t b, uint32_t* destino);
+void liberarIndiceAncestrais(IndiceAncestrais* indice);
+int executarRota(int argc, char* argv[]);
+
+// Motor de dicas (pista pendente mais próxima)
+void iniciarArvoreMinimos(ArvoreMinimos* arvore, uint32_t n);
+NoMinimo menorNo(NoMinimo a, NoMinimo b);
+void construirArvoreMinimos(ArvoreMinimos* arvore);
+void atualizarArvoreMinimos(ArvoreMinimos* arvore, uint32_t posicao, int64_t valor, uint32_t sala);
+NoMinimo consultarArvoreMinimos(const ArvoreMinimos* arvore, uint32_t inicio, uint32_t fim);
+OrdemSalas* criarOrdemSalas(const MapaGrafo* mapa, uint32_t raiz);
+void liberarOrdemSalas(OrdemSalas* ordem);
+MotorDicas* criarMotorDicas(const OrdemSalas* ordem, const uint64_t* pendentes);
+void marcarPistaPendente(MotorDicas* motor, uint32_t sala, int pendente);
+uint32_t pistaMaisProximaEmLargura(MotorDicas* motor, uint32_t origem, uint32_t* distancia);
+uint32_t pistaMaisProxima(MotorDicas* motor, uint32_t origem, uint32_t* distancia);
+uint32_t caminhoDaDica(const MotorDicas* motor, uint32_t origem, uint32_t alvo, uint32_t* destino);
+void liberarMotorDicas(MotorDicas* motor);
+MotorDicas* criarMotorDicasSessao(const OrdemSalas* ordem, const BaseEvidencias* base,
+                                  const uint64_t* pistasColetadas, int suspeito);
+void exibirDica(const MapaGrafo* mapa, MotorDicas* motor, uint32_t origem);
+
+// Textos compactados (tabela de símbolos)
+uint64_t ganhoCandidato(const CandidatoSimbolo* candidato);
+int compararCandidatos(const void* a, const void* b);
+void contarCandidato(CandidatoSimbolo* tabela, uint32_t mascara, const char* bytes, uint8_t tamanho, uint32_t contagem);
+void indexarTabelaSimbolos(TabelaSimbolos* tabela);
+int casarSimbolo(const TabelaSimbolos* tabela, const char* texto, size_t restante);
+void treinarTabelaSimbolos(TabelaSimbolos* tabela, const char* amostra, size_t tamanho);
+size_t codificarTexto(const TabelaSimbolos* tabela, const char* texto, uint8_t* destino);
+size_t decodificarTexto(const TabelaSimbolos* tabela, const uint8_t* codigo, char* destino, size_t capacidade);
+size_t tamanhoTextosMapa(const MapaGrafo* mapa);
+size_t compactarTextosMapa(MapaGrafo* mapa);
+const char* textoDoMapa(const MapaGrafo* mapa, uint32_t deslocamento, char* buffer);
+
+// Árvore sucinta (2 bits por sala, rank/select)
+int contarUns(uint64_t x);
+int selecionarNaPalavra(uint64_t x, uint32_t r);
+ArvoreSucinta* criarArvoreSucinta(const MansaoGerada* mansao, uint32_t* ordem);
+uint32_t rankSucinto(const ArvoreSucinta* arvore, size_t posicao);
+size_t selectSucinto(const ArvoreSucinta* arvore, uint32_t k);
+uint32_t filhoSucinto(const ArvoreSucinta* arvore, uint32_t sala, int lado);
+uint32_t paiSucinto(const ArvoreSucinta* arvore, uint32_t sala);
+size_t bytesArvoreSucinta(const ArvoreSucinta* arvore);
+void liberarArvoreSucinta(ArvoreSucinta* arvore);
+void renumerarMansaoEmLargura(MansaoGerada* mansao);
+void explorarArvoreSucinta(const ArvoreSucinta* arvore, const int32_t* suspeitoDaSala, PistaNode** bstPistas,
+                           HashNode* tabelaHash[], RankingSuspeitos* ranking, uint64_t* pistasColetadas);
+int executarMansaoSucinta(int argc, char* argv[]);
+
+// Registro de sessões e análise colunar
+RegistroSessao* abrirRegistroSessao(const char* caminho, const MapaGrafo* mapa, const BaseEvidencias* base);
+void registrarEvento(RegistroSessao* registro, uint8_t tipo, uint32_t valor, uint8_t acerto);
+void registrarBaseSessao(RegistroSessao* registro, const BaseEvidencias* base);
+void gravarSalasComPista(const RegistroSessao* registro, uint32_t assinatura, const BaseEvidencias* base);
+void fecharRegistroSessao(RegistroSessao* registro);
+uint32_t hashBytes(uint32_t hash, const void* dados, size_t tamanho);
+uint32_t assinaturaMapa(const MapaGrafo* mapa);
+uint32_t assinaturaBase(const BaseEvidencias* base);
+int lerSalasComPista(FILE* arquivo, SalasComPista** conjuntos, uint32_t* nConjuntos, int unicos);
+int executarConversaoColunar(int argc, char* argv[]);
+uint64_t* histogramaPorValor(const uint8_t* tipo, const uint32_t* valor, const uint8_t* acerto, const uint32_t* grupo,
+                             const uint8_t* incluir, int64_t n, uint8_t tipoProcurado, uint32_t nValores);
+void exibirDestaques(const char* titulo, const char* rotulo, const uint64_t* contagem, uint32_t nValores,
+                     const uint64_t* referencia, int limite, int menores);
+uint32_t agruparPorAssinatura(const uint8_t* tipo, const uint32_t* valor, const uint64_t* sessao, int64_t n,
+                              uint64_t sessoes, uint32_t* grupo, GrupoAnalise** grupos);
+uint64_t* contarSalasComPista(const GrupoAnalise* grupos, uint32_t nGrupos, const uint8_t* incluir,
+                              const SalasComPista* conjuntos, uint32_t nConjuntos, uint32_t nValores);
+void exibirAnaliseSalas(const uint8_t* tipo, const uint32_t* valor, const uint8_t* acerto, const uint32_t* grupo,
+                        const uint8_t* incluir, int64_t n, uint32_t nValores, uint64_t sessoes, const uint64_t* comPista);
+void exibirAnaliseSuspeitos(const uint8_t* tipo, const uint32_t* valor, const uint8_t* acerto, const uint32_t* grupo,
+                            const uint8_t* incluir, int64_t n, uint32_t nValores);
+int executarAnalise(int argc, char* argv[]);
+
+// Recarga da base de pistas (publicação RCU por épocas)
+PublicacaoBase* criarPublicacaoBase(BaseEvidencias* inicial);
+int registrarLeitorBase(PublicacaoBase* publicacao);
+const BaseEvidencias* lerBaseAtual(PublicacaoBase* publicacao, int leitor, uint32_t* numero);
+void sairLeituraBase(PublicacaoBase* publicacao, int leitor);
+void liberarLeitorBase(PublicacaoBase* publicacao, int leitor);
+int recolherVersoesBase(PublicacaoBase* publicacao);
+void publicarBase(PublicacaoBase* publicacao, BaseEvidencias* nova);
+BaseEvidencias* lerBaseDeTexto(char* conteudo);
+int recarregarBaseDoArquivo(PublicacaoBase* publicacao);
+#ifndef __STDC_NO_THREADS__
+int executarRecargaBase(void* argumento);
+#endif
+int iniciarRecargaBase(PublicacaoBase* publicacao, const char* caminho);
+void pararRecargaBase(PublicacaoBase* publicacao);
+int conectarRankingPublicacao(RankingSuspeitos* ranking, PublicacaoBase* publicacao);
+int sincronizarBase(RankingSuspeitos* ranking, HashNode* tabelaHash[]);
+#ifndef __STDC_NO_THREADS__
+int executarLeitorBase(void* argumento);
+#endif
+void liberarPublicacaoBase(PublicacaoBase* publicacao);
+int exportarBaseCaso(int argc, char* argv[]);
+
 // Funções de Lógica do Jogo
-const char* getSuspeitoParaPista(const char* pista);
 int contarPistasParaSuspeito(PistaNode* raizPistas, HashNode* tabelaHash[], const char* suspeito);
-void explorarSalas(Sala* salaInicial, PistaNode** bstPistas, HashNode* tabelaHash[]);
-void verificarSuspeitoFinal(PistaNode* bstPistas, HashNode* tabelaHash[]);
+void verificarSuspeitoFinal(PistaNode* bstPistas, HashNode* tabelaHash[], RankingSuspeitos* ranking,
+                            RegistroSessao* registro);
+
+// Gerador procedural de mansões
+uint64_t aleatorioDoIndice(uint64_t semente, uint64_t fluxo, uint64_t indice);
+double relogioParede(void);
+int formaPorNome(const char* nome);
+MansaoGerada* alocarMansaoGerada(uint32_t nSalas, uint32_t nSuspeitos, uint64_t semente, int forma);
+void gerarSubarvoreAleatoria(MansaoGerada* mansao, uint32_t inicio, uint32_t tamanho);
+MansaoGerada* gerarMansao(uint32_t nSalas, int forma, uint64_t semente, uint32_t nSuspeitos);
+void nomeSalaGerada(uint32_t sala, char* destino, size_t tamanho);
+void pistaSalaGerada(uint32_t sala, char* destino, size_t tamanho);
+void nomeSuspeitoGerado(uint32_t suspeito, char* destino, size_t tamanho);
+Sala* construirSalasGeradas(const MansaoGerada* mansao);
+BaseEvidencias* criarBaseGerada(const MansaoGerada* mansao);
+int salvarMansao(const MansaoGerada* mansao, const char* caminho);
+MansaoGerada* carregarMansao(const char* caminho);
+void liberarMansaoGerada(MansaoGerada* mansao);
+int executarGerador(int argc, char* argv[]);
+
+// Medição de desempenho
+double segundosDesde(clock_t inicio);
+int executarBenchmarks(long n);
 
 
 // ----------------------------------------------------------------------------
 // FUNÇÃO PRINCIPAL
 // ----------------------------------------------------------------------------
 
-int main() {
-    // --- Montagem do Mapa da Mansão (Árvore Binária) ---
-    Sala* hall = criarSala("Hall de Entrada", "Um jornal velho sobre a mesa, com a data de 1920.");
-    Sala* salaDeJantar = criarSala("Sala de Jantar", "Um candelabro de prata polido, fora do lugar.");
-    Sala* biblioteca = criarSala("Biblioteca", "Um livro sobre venenos com uma pagina marcada.");
-    Sala* cozinha = criarSala("Cozinha", "Uma faca de cozinha faltando no conjunto.");
-    Sala* escritorio = criarSala("Escritorio", "Uma carta de ameaca enderecada a vitima.");
-    Sala* jardimSecreto = criarSala("Jardim Secreto", "Pegadas de sapatos caros na lama.");
-
-    hall->esquerda = salaDeJantar;
-    hall->direita = biblioteca;
-    salaDeJantar->esquerda = cozinha;
-    biblioteca->esquerda = escritorio;
-    biblioteca->direita = jardimSecreto;
+int main(int argc, char* argv[]) {
+    // Opções globais: ./mestre [--log <arquivo>] [--base <arquivo>] [modo ...]
+    // --log grava o registro da sessão; --base joga o caso com uma base de pistas recarregável
+    const char* caminhoRegistro = NULL;
+    const char* caminhoBase = NULL;
+    while (argc > 2 && (strcmp(argv[1], "--log") == 0 || strcmp(argv[1], "--base") == 0)) {
+        if (strcmp(argv[1], "--log") == 0) {
+            caminhoRegistro = argv[2];
+        } else {
+            caminhoBase = argv[2];
+        }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+    // A base recarregável só vale para o jogo do caso; os outros modos têm base própria
+    if (caminhoBase && argc > 1 && strncmp(argv[1], "--", 2) == 0) {
+        printf("Uso: %s [--log <arquivo>] --base <arquivo> (sem modo: --base nao vale com %s)\n", argv[0], argv[1]);
+        return 1;
+    }
+    // Só o jogo do caso e o --jogar gravam o registro de sessão
+    if (caminhoRegistro && argc > 1 && strncmp(argv[1], "--", 2) == 0 && strcmp(argv[1], "--jogar") != 0) {
+        printf("Uso: %s --log <arquivo> [--jogar ...] (--log nao vale com %s)\n", argv[0], argv[1]);
+        return 1;
+    }
+
+    // Modo de medição: ./mestre --bench [quantidade de nós]
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return executarBenchmarks(argc > 2 ? atol(argv[2]) : 1000000);
+    }
+    // Gerador de mansões: ./mestre --gerar <forma> <salas> <semente> <arquivo> [suspeitos]
+    if (argc > 1 && strcmp(argv[1], "--gerar") == 0) {
+        return executarGerador(argc, argv);
+    }
+    // Jogar uma mansão gerada: ./mestre --jogar <arquivo> [passagens extras]
+    if (argc > 1 && strcmp(argv[1], "--jogar") == 0) {
+        return executarMansaoArquivo(argc, argv, caminhoRegistro);
+    }
+    // Mansão sobre a árvore sucinta: ./mestre --sucinta <arquivo>
+    if (argc > 1 && strcmp(argv[1], "--sucinta") == 0) {
+        return executarMansaoSucinta(argc, argv);
+    }
+    // Caminho entre salas: ./mestre --rota <arquivo> <origem> <destino> [sala]
+    if (argc > 1 && strcmp(argv[1], "--rota") == 0) {
+        return executarRota(argc, argv);
+    }
+    // Análise offline: ./mestre --colunar <saida.dqc> <registro>... e ./mestre --analisar <arquivo.dqc>
+    if (argc > 1 && strcmp(argv[1], "--colunar") == 0) {
+        return executarConversaoColunar(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--analisar") == 0) {
+        return executarAnalise(argc, argv);
+    }
+    // Base de pistas do caso em texto, pronta para editar e usar com --base
+    if (argc > 1 && strcmp(argv[1], "--exportar-base") == 0) {
+        return exportarBaseCaso(argc, argv);
+    }
+
+    // --- Mapa da Mansão ---
+    // O mapa do caso (MAPA_CASO) é montado em tempo de compilação; não há nada a alocar.
 
     // --- Inicialização das Estruturas ---
     PistaNode* bstPistas = NULL; // Raiz da BST de pistas
+    // A base começa com as associações do caso e pode ser trocada durante a partida
+    BaseEvidencias* base = criarBaseEvidencias(ASSOCIACOES_CASO, NUM_ASSOCIACOES_CASO);
+    PublicacaoBase* publicacao = criarPublicacaoBase(base);
+    RankingSuspeitos* ranking = criarRanking(base, TOP_K_SUSPEITOS); // Compartilhado pela equipe
+    conectarRankingPublicacao(ranking, publicacao);
     HashNode* tabelaHash[HASH_SIZE]; // Tabela Hash para Pista -> Suspeito
+    OrdemSalas* ordem = NULL; // Dicas de todos os detetives, montada na primeira dica
 
     // Inicializa todos os ponteiros da tabela hash como NULL
     for (int i = 0; i < HASH_SIZE; i++) {
         tabelaHash[i] = NULL;
     }
 
+    if (caminhoBase) {
+        if (!iniciarRecargaBase(publicacao, caminhoBase)) {
+            printf("(Nao foi possivel carregar %s; usando as pistas do caso ate ele ficar valido.)\n", caminhoBase);
+        }
+        sincronizarBase(ranking, tabelaHash);
+    }
+    RegistroSessao* registro = caminhoRegistro ? abrirRegistroSessao(caminhoRegistro, &MAPA_CASO, ranking->base) : NULL;
+
     printf("=======================================\n");
     printf("        Bem-vindo ao Detective Quest!       \n");
     printf("=======================================\n");
     printf("Explore a mansao, colete pistas, e descubra o culpado.\n");
 
-    // Inicia a exploração
-    explorarSalas(hall, &bstPistas, tabelaHash);
+    int numDetetives = 0;
+    printf("Quantos detetives participam da investigacao? (1-%d): ", MAX_DETETIVES);
+    if (scanf("%d", &numDetetives) != 1 || numDetetives < 1 || numDetetives > MAX_DETETIVES) {
+        numDetetives = 1;
+    }
+
+    // Inicia a exploração: cada detetive percorre a mansão com sua própria BST
+    // e seu próprio conjunto de pistas já coletadas
+    PistaNode* pistasDetetive[MAX_DETETIVES] = { NULL };
+    uint64_t pistasColetadas[(NUM_SALAS_CASO + 63) / 64];
+    for (int d = 0; d < numDetetives; d++) {
+        if (numDetetives > 1) {
+            printf("\n=======================================\n");
+            printf("        Vez do Detetive %d\n", d + 1);
+            printf("=======================================\n");
+        }
+        memset(pistasColetadas, 0, sizeof(pistasColetadas));
+        explorarMapa(&MAPA_CASO, CASO_HALL, &pistasDetetive[d], tabelaHash, ranking, pistasColetadas, registro,
+                     &ordem);
+    }
+
+    // Junta as evidências de todos os detetives em um único índice balanceado
+    bstPistas = pistasDetetive[0];
+    PistaNode* confirmadas = NULL;
+    if (numDetetives > 1) {
+        confirmadas = mesclarPistas(pistasDetetive[0], NULL);
+        for (int d = 1; d < numDetetives; d++) {
+            PistaNode* uniao = mesclarPistas(bstPistas, pistasDetetive[d]);
+            PistaNode* comum = intersectarPistas(confirmadas, pistasDetetive[d]);
+            liberarPistas(bstPistas);
+            liberarPistas(confirmadas);
+            liberarPistas(pistasDetetive[d]);
+            bstPistas = uniao;
+            confirmadas = comum;
+        }
+
+        printf("\nPistas encontradas por todos os detetives:\n");
+        if (confirmadas == NULL) {
+            printf("- Nenhuma.\n");
+        } else {
+            exibirPistas(confirmadas);
+        }
+    }
 
     // Inicia a fase de julgamento
-    verificarSuspeitoFinal(bstPistas, tabelaHash);
+    verificarSuspeitoFinal(bstPistas, tabelaHash, ranking, registro);
 
     // --- Limpeza de Memória ---
-    liberarMapa(hall);
+    fecharRegistroSessao(registro);
+    liberarOrdemSalas(ordem);
     liberarPistas(bstPistas);
+    liberarPistas(confirmadas);
     liberarHash(tabelaHash);
+    pararRecargaBase(publicacao);
+    liberarRanking(ranking);
+    liberarPublicacaoBase(publicacao);
 
     return 0;
 }
@@ -122,59 +748,194 @@ Sala* criarSala(const char* nome, const char* pista) {
 }
 
 /**
- * @brief Navega pela árvore da mansão, coleta pistas, as insere na BST e na Tabela Hash.
+ * @brief Insere a pista coletada na árvore de pistas (BST) de forma ordenada.
+ * A descida é iterativa, então árvores degeneradas não estouram a pilha.
  */
-void explorarSalas(Sala* salaAtual, PistaNode** bstPistas, HashNode* tabelaHash[]) {
-    char escolha;
-    while (salaAtual != NULL) {
-        printf("\n---------------------------------------\n");
-        printf("Voce esta em: %s\n", salaAtual->nome);
-
-        // Verifica se há uma pista e a processa
-        if (strlen(salaAtual->pista) > 0) {
-            const char* suspeitoAssociado = getSuspeitoParaPista(salaAtual->pista);
-            if (suspeitoAssociado) {
-                printf(">>> Pista encontrada: \"%s\" <<<\n", salaAtual->pista);
-                // Adiciona na BST e na Tabela Hash
-                *bstPistas = adicionarPista(*bstPistas, salaAtual->pista);
-                inserirNaHash(tabelaHash, salaAtual->pista, suspeitoAssociado);
-                // "Remove" a pista da sala para não ser coletada novamente
-                strcpy(salaAtual->pista, "");
-            }
+PistaNode* adicionarPista(PistaNode* raiz, const char* novaPista) {
+    PistaNode** ligacao = &raiz;
+    while (*ligacao != NULL) {
+        int cmp = strcmp(novaPista, (*ligacao)->pista);
+        if (cmp < 0) {
+            ligacao = &(*ligacao)->esquerda;
+        } else if (cmp > 0) {
+            ligacao = &(*ligacao)->direita;
         } else {
-            printf("Nenhuma pista nova neste comodo.\n");
+            return raiz; // Pista repetida
         }
-        
-        printf("Para onde voce quer ir? (e/d/s): ");
-        scanf(" %c", &escolha);
+    }
+    PistaNode* novoNode = (PistaNode*) malloc(sizeof(PistaNode));
+    if (!novoNode) exit(1);
+    strcpy(novoNode->pista, novaPista);
+    novoNode->esquerda = novoNode->direita = NULL;
+    *ligacao = novoNode;
+    return raiz;
+}
 
-        switch (escolha) {
-            case 'e': case 'E': salaAtual = salaAtual->esquerda; break;
-            case 'd': case 'D': salaAtual = salaAtual->direita; break;
-            case 's': case 'S': salaAtual = NULL; break; // Sair
-            default: printf("Opcao invalida.\n"); break;
+/**
+ * @brief Percorre a BST em ordem sem recursão e sem pilha auxiliar (percurso de Morris).
+ * Os ponteiros direitos são usados temporariamente como "fios" até o sucessor e
+ * restaurados antes do retorno; `visitar` não deve alterar a estrutura da árvore.
+ */
+void percorrerEmOrdem(PistaNode* raiz, VisitaPista visitar, void* contexto) {
+    PistaNode* atual = raiz;
+    while (atual != NULL) {
+        if (atual->esquerda == NULL) {
+            visitar(atual, contexto);
+            atual = atual->direita;
+            continue;
+        }
+        PistaNode* predecessor = atual->esquerda;
+        while (predecessor->direita != NULL && predecessor->direita != atual) {
+            predecessor = predecessor->direita;
+        }
+        if (predecessor->direita == NULL) {
+            predecessor->direita = atual; // Cria o fio e desce à esquerda
+            atual = atual->esquerda;
+        } else {
+            predecessor->direita = NULL; // Sub-árvore esquerda concluída: desfaz o fio
+            visitar(atual, contexto);
+            atual = atual->direita;
         }
     }
 }
 
+// --- Operações em Lote (Modo Cooperativo) ---
+
+void visitaContar(PistaNode* node, void* contexto) {
+    (void) node;
+    (*(int*) contexto)++;
+}
+
 /**
- * @brief Insere a pista coletada na árvore de pistas (BST) de forma ordenada.
+ * @brief Conta quantas pistas existem na BST.
  */
-PistaNode* adicionarPista(PistaNode* raiz, const char* novaPista) {
-    if (raiz == NULL) {
-        PistaNode* novoNode = (PistaNode*) malloc(sizeof(PistaNode));
-        if (!novoNode) exit(1);
-        strcpy(novoNode->pista, novaPista);
-        novoNode->esquerda = novoNode->direita = NULL;
-        return novoNode;
-    }
-    int cmp = strcmp(novaPista, raiz->pista);
-    if (cmp < 0) {
-        raiz->esquerda = adicionarPista(raiz->esquerda, novaPista);
-    } else if (cmp > 0) {
-        raiz->direita = adicionarPista(raiz->direita, novaPista);
+int contarPistas(PistaNode* raiz) {
+    int total = 0;
+    percorrerEmOrdem(raiz, visitaContar, &total);
+    return total;
+}
+
+typedef struct {
+    const char** destino;
+    int pos;
+} ContextoListagem;
+
+void visitaListar(PistaNode* node, void* contexto) {
+    ContextoListagem* lista = (ContextoListagem*) contexto;
+    lista->destino[lista->pos++] = node->pista;
+}
+
+/**
+ * @brief Copia os ponteiros das pistas da BST, em ordem alfabética, para `destino`
+ * a partir da posição `pos`.
+ * @return A próxima posição livre em `destino`.
+ */
+int listarPistasEmOrdem(PistaNode* raiz, const char* destino[], int pos) {
+    ContextoListagem lista = { destino, pos };
+    percorrerEmOrdem(raiz, visitaListar, &lista);
+    return lista.pos;
+}
+
+/**
+ * @brief Monta uma sub-árvore balanceada com as pistas do intervalo [inicio, fim).
+ * A recursão tem profundidade log2(n), pois a árvore resultante é balanceada.
+ */
+PistaNode* construirIntervaloBalanceado(const char* pistas[], int inicio, int fim) {
+    if (inicio >= fim) {
+        return NULL;
     }
-    return raiz;
+    int meio = inicio + (fim - inicio) / 2;
+    PistaNode* novoNode = (PistaNode*) malloc(sizeof(PistaNode));
+    if (!novoNode) exit(1);
+    strcpy(novoNode->pista, pistas[meio]);
+    novoNode->esquerda = construirIntervaloBalanceado(pistas, inicio, meio);
+    novoNode->direita = construirIntervaloBalanceado(pistas, meio + 1, fim);
+    return novoNode;
+}
+
+/**
+ * @brief Constrói em O(n) uma BST balanceada a partir de um lote de pistas já
+ * ordenado e sem repetições.
+ */
+PistaNode* construirPistasBalanceadas(const char* pistas[], int n) {
+    return construirIntervaloBalanceado(pistas, 0, n);
+}
+
+/**
+ * @brief Lineariza duas BSTs em vetores ordenados. O chamador libera `*va`
+ * (os dois vetores compartilham a mesma alocação).
+ */
+void linearizarPares(PistaNode* a, PistaNode* b, const char*** va, int* na, const char*** vb, int* nb) {
+    *na = contarPistas(a);
+    *nb = contarPistas(b);
+    *va = (const char**) malloc(sizeof(const char*) * (size_t)(*na + *nb + 1));
+    if (!*va) exit(1);
+    *vb = *va + *na;
+    listarPistasEmOrdem(a, *va, 0);
+    listarPistasEmOrdem(b, *vb, 0);
+}
+
+/**
+ * @brief Une as pistas de duas BSTs em tempo linear (intercalação de dois
+ * percursos em ordem), devolvendo uma nova BST balanceada.
+ * As árvores de entrada não são modificadas.
+ */
+PistaNode* mesclarPistas(PistaNode* a, PistaNode* b) {
+    const char **va, **vb;
+    int na, nb;
+    linearizarPares(a, b, &va, &na, &vb, &nb);
+
+    const char** uniao = (const char**) malloc(sizeof(const char*) * (size_t)(na + nb + 1));
+    if (!uniao) exit(1);
+    int i = 0, j = 0, n = 0;
+    while (i < na && j < nb) {
+        int cmp = strcmp(va[i], vb[j]);
+        if (cmp < 0) {
+            uniao[n++] = va[i++];
+        } else if (cmp > 0) {
+            uniao[n++] = vb[j++];
+        } else {
+            uniao[n++] = va[i++];
+            j++;
+        }
+    }
+    while (i < na) uniao[n++] = va[i++];
+    while (j < nb) uniao[n++] = vb[j++];
+
+    PistaNode* resultado = construirPistasBalanceadas(uniao, n);
+    free(uniao);
+    free(va);
+    return resultado;
+}
+
+/**
+ * @brief Devolve, em tempo linear, uma nova BST balanceada com as pistas
+ * presentes nas duas árvores. As árvores de entrada não são modificadas.
+ */
+PistaNode* intersectarPistas(PistaNode* a, PistaNode* b) {
+    const char **va, **vb;
+    int na, nb;
+    linearizarPares(a, b, &va, &na, &vb, &nb);
+
+    const char** comum = (const char**) malloc(sizeof(const char*) * (size_t)(na + 1));
+    if (!comum) exit(1);
+    int i = 0, j = 0, n = 0;
+    while (i < na && j < nb) {
+        int cmp = strcmp(va[i], vb[j]);
+        if (cmp < 0) {
+            i++;
+        } else if (cmp > 0) {
+            j++;
+        } else {
+            comum[n++] = va[i++];
+            j++;
+        }
+    }
+
+    PistaNode* resultado = construirPistasBalanceadas(comum, n);
+    free(comum);
+    free(va);
+    return resultado;
 }
 
 /**
@@ -211,11 +972,28 @@ const char* encontrarSuspeito(HashNode* tabela[], const char* pista) {
     return NULL; // Não encontrado
 }
 
+/**
+ * @brief Troca o suspeito associado a uma pista já presente na tabela hash.
+ */
+void atualizarSuspeitoNaHash(HashNode* tabela[], const char* pista, const char* suspeito) {
+    for (HashNode* atual = tabela[hashFunction(pista)]; atual != NULL; atual = atual->next) {
+        if (strcmp(atual->pista, pista) == 0) {
+            snprintf(atual->suspeito, sizeof(atual->suspeito), "%s", suspeito);
+            return;
+        }
+    }
+}
+
 /**
  * @brief Conduz a fase de julgamento final. Pede ao jogador uma acusação
  * e verifica se há evidências suficientes (>= 2 pistas).
+ * A acusação é gravada no registro da sessão, se houver um.
  */
-void verificarSuspeitoFinal(PistaNode* bstPistas, HashNode* tabelaHash[]) {
+void verificarSuspeitoFinal(PistaNode* bstPistas, HashNode* tabelaHash[], RankingSuspeitos* ranking,
+                            RegistroSessao* registro) {
+    if (sincronizarBase(ranking, tabelaHash)) { // O veredito usa a versão mais recente da base
+        registrarBaseSessao(registro, ranking->base);
+    }
     printf("\n=======================================\n");
     printf("        J U L G A M E N T O\n");
     printf("=======================================\n");
@@ -228,7 +1006,15 @@ void verificarSuspeitoFinal(PistaNode* bstPistas, HashNode* tabelaHash[]) {
     printf("Pistas coletadas em ordem alfabetica:\n");
     exibirPistas(bstPistas);
 
-    printf("\nSuspeitos possiveis: Mordomo, Jardineiro, Cozinheira, Dama_da_noite\n");
+    printf("\n");
+    exibirRanking(ranking);
+
+    const IndiceTexto* suspeitos = &ranking->base->suspeitos;
+    printf("\nSuspeitos possiveis: ");
+    for (int i = 0; i < suspeitos->quantidade && i < 10; i++) {
+        printf(i ? ", %s" : "%s", suspeitos->textos[i]);
+    }
+    printf(suspeitos->quantidade > 10 ? ", ...\n" : "\n");
     char acusado[50];
     printf("Quem voce acusa de ser o culpado? ");
     scanf("%49s", acusado);
@@ -237,6 +1023,8 @@ void verificarSuspeitoFinal(PistaNode* bstPistas, HashNode* tabelaHash[]) {
     
     printf("\n--- Veredito ---\n");
     printf("Voce acusou %s. A investigacao revelou %d pista(s) contra esta pessoa.\n", acusado, contagemPistas);
+    int idAcusado = buscarNoIndice(&ranking->base->suspeitos, acusado);
+    registrarEvento(registro, EVENTO_ACUSACAO, idAcusado >= 0 ? (uint32_t) idAcusado : SEM_SALA, contagemPistas >= 2);
 
     if (contagemPistas >= 2) {
         printf("Evidencias suficientes! Voce desvendou o misterio! PARABENS!\n");
@@ -245,6 +1033,317 @@ void verificarSuspeitoFinal(PistaNode* bstPistas, HashNode* tabelaHash[]) {
     }
 }
 
+// --- Base de Evidências (pista -> suspeitos com pesos) e Ranking ---
+
+/**
+ * @brief Hash FNV-1a de 32 bits, usado pelos índices de texto com endereçamento aberto.
+ */
+uint32_t hashTexto(const char* str) {
+    uint32_t hash = 2166136261u;
+    while (*str) {
+        hash ^= (unsigned char) *str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Gerador pseudoaleatório splitmix64: rápido e totalmente determinado pela semente.
+ */
+uint64_t proximoAleatorio(uint64_t* estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Copia uma string para memória alocada dinamicamente.
+ */
+char* duplicarTexto(const char* texto) {
+    size_t tamanho = strlen(texto) + 1;
+    char* copia = (char*) malloc(tamanho);
+    if (!copia) exit(1);
+    memcpy(copia, texto, tamanho);
+    return copia;
+}
+
+/**
+ * @brief Prepara um índice vazio com espaço para até `maxTextos` textos distintos.
+ */
+void iniciarIndiceTexto(IndiceTexto* indice, int maxTextos) {
+    indice->capacidade = 16;
+    while (indice->capacidade < 2u * (uint32_t) maxTextos) {
+        indice->capacidade <<= 1;
+    }
+    indice->slots = (int*) malloc(sizeof(int) * indice->capacidade);
+    indice->textos = (char**) malloc(sizeof(char*) * (size_t) (maxTextos > 0 ? maxTextos : 1));
+    if (!indice->slots || !indice->textos) exit(1);
+    memset(indice->slots, -1, sizeof(int) * indice->capacidade);
+    indice->quantidade = 0;
+}
+
+/**
+ * @brief Procura um texto no índice (sondagem linear).
+ * @return O id do texto, ou -1 se não estiver cadastrado.
+ */
+int buscarNoIndice(const IndiceTexto* indice, const char* texto) {
+    uint32_t mascara = indice->capacidade - 1;
+    for (uint32_t i = hashTexto(texto) & mascara; indice->slots[i] != -1; i = (i + 1) & mascara) {
+        if (strcmp(indice->textos[indice->slots[i]], texto) == 0) {
+            return indice->slots[i];
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Devolve o id de um texto, cadastrando uma cópia dele se ainda não existir.
+ */
+int obterIdNoIndice(IndiceTexto* indice, const char* texto) {
+    uint32_t mascara = indice->capacidade - 1;
+    uint32_t i = hashTexto(texto) & mascara;
+    for (; indice->slots[i] != -1; i = (i + 1) & mascara) {
+        if (strcmp(indice->textos[indice->slots[i]], texto) == 0) {
+            return indice->slots[i];
+        }
+    }
+    int id = indice->quantidade++;
+    indice->textos[id] = duplicarTexto(texto);
+    indice->slots[i] = id;
+    return id;
+}
+
+void liberarIndiceTexto(IndiceTexto* indice) {
+    for (int i = 0; i < indice->quantidade; i++) {
+        free(indice->textos[i]);
+    }
+    free(indice->textos);
+    free(indice->slots);
+}
+
+/**
+ * @brief Monta a base de evidências a partir de uma lista de associações
+ * pista -> suspeito. Uma pista pode aparecer várias vezes (vários suspeitos).
+ * As ligações ficam em formato CSR: as de uma pista `p` ocupam as posições
+ * [inicio[p], inicio[p + 1]) dos vetores `suspeito` e `peso`.
+ * Pesos negativos são tratados como zero (a pontuação só pode crescer).
+ */
+BaseEvidencias* criarBaseEvidencias(const AssociacaoPista associacoes[], int n) {
+    BaseEvidencias* base = (BaseEvidencias*) malloc(sizeof(BaseEvidencias));
+    int* pistaDe = (int*) malloc(sizeof(int) * (size_t) (n > 0 ? n : 1));
+    int* suspeitoDe = (int*) malloc(sizeof(int) * (size_t) (n > 0 ? n : 1));
+    if (!base || !pistaDe || !suspeitoDe) exit(1);
+    iniciarIndiceTexto(&base->pistas, n);
+    iniciarIndiceTexto(&base->suspeitos, n);
+
+    for (int i = 0; i < n; i++) {
+        pistaDe[i] = obterIdNoIndice(&base->pistas, associacoes[i].pista);
+        suspeitoDe[i] = obterIdNoIndice(&base->suspeitos, associacoes[i].suspeito);
+    }
+
+    int nPistas = base->pistas.quantidade;
+    base->inicio = (int*) calloc((size_t) nPistas + 1, sizeof(int));
+    base->suspeito = (int*) malloc(sizeof(int) * (size_t) (n > 0 ? n : 1));
+    base->peso = (float*) malloc(sizeof(float) * (size_t) (n > 0 ? n : 1));
+    if (!base->inicio || !base->suspeito || !base->peso) exit(1);
+
+    // Contagem por pista, soma de prefixos e preenchimento estável
+    for (int i = 0; i < n; i++) base->inicio[pistaDe[i] + 1]++;
+    for (int p = 0; p < nPistas; p++) base->inicio[p + 1] += base->inicio[p];
+    int* proxima = (int*) malloc(sizeof(int) * (size_t) (nPistas > 0 ? nPistas : 1));
+    if (!proxima) exit(1);
+    memcpy(proxima, base->inicio, sizeof(int) * (size_t) nPistas);
+    for (int i = 0; i < n; i++) {
+        int pos = proxima[pistaDe[i]]++;
+        base->suspeito[pos] = suspeitoDe[i];
+        base->peso[pos] = associacoes[i].peso > 0 ? associacoes[i].peso : 0.0f;
+    }
+
+    free(proxima);
+    free(suspeitoDe);
+    free(pistaDe);
+    return base;
+}
+
+void liberarBaseEvidencias(BaseEvidencias* base) {
+    if (!base) return;
+    liberarIndiceTexto(&base->pistas);
+    liberarIndiceTexto(&base->suspeitos);
+    free(base->inicio);
+    free(base->suspeito);
+    free(base->peso);
+    free(base);
+}
+
+/**
+ * @brief Cria um ranking vazio que mantém os `k` suspeitos de maior pontuação.
+ */
+RankingSuspeitos* criarRanking(const BaseEvidencias* base, int k) {
+    RankingSuspeitos* ranking = (RankingSuspeitos*) calloc(1, sizeof(RankingSuspeitos));
+    if (!ranking) exit(1);
+    ranking->kPedido = k;
+    ranking->leitor = -1;
+    prepararRanking(ranking, base);
+    return ranking;
+}
+
+/**
+ * @brief Zera as pontuações do ranking e o dimensiona para os suspeitos de `base`.
+ */
+void prepararRanking(RankingSuspeitos* ranking, const BaseEvidencias* base) {
+    int nSuspeitos = base->suspeitos.quantidade;
+    ranking->base = base;
+    ranking->k = ranking->kPedido < nSuspeitos ? ranking->kPedido : nSuspeitos;
+    ranking->tamanho = 0;
+    ranking->pontuacao = (double*) calloc((size_t) nSuspeitos + 1, sizeof(double));
+    ranking->posHeap = (int*) malloc(sizeof(int) * ((size_t) nSuspeitos + 1));
+    ranking->heap = (int*) malloc(sizeof(int) * ((size_t) ranking->k + 1));
+    if (!ranking->pontuacao || !ranking->posHeap || !ranking->heap) exit(1);
+    memset(ranking->posHeap, -1, sizeof(int) * ((size_t) nSuspeitos + 1));
+}
+
+/**
+ * @brief Ordem do heap: menor pontuação primeiro; empates favorecem o menor id no topo do ranking.
+ */
+int rankingMenor(const RankingSuspeitos* ranking, int a, int b) {
+    if (ranking->pontuacao[a] != ranking->pontuacao[b]) {
+        return ranking->pontuacao[a] < ranking->pontuacao[b];
+    }
+    return a > b;
+}
+
+void trocarNoHeap(RankingSuspeitos* ranking, int i, int j) {
+    int a = ranking->heap[i], b = ranking->heap[j];
+    ranking->heap[i] = b;
+    ranking->heap[j] = a;
+    ranking->posHeap[b] = i;
+    ranking->posHeap[a] = j;
+}
+
+void descerNoHeap(RankingSuspeitos* ranking, int i) {
+    for (;;) {
+        int menor = i, e = 2 * i + 1, d = 2 * i + 2;
+        if (e < ranking->tamanho && rankingMenor(ranking, ranking->heap[e], ranking->heap[menor])) menor = e;
+        if (d < ranking->tamanho && rankingMenor(ranking, ranking->heap[d], ranking->heap[menor])) menor = d;
+        if (menor == i) return;
+        trocarNoHeap(ranking, i, menor);
+        i = menor;
+    }
+}
+
+void subirNoHeap(RankingSuspeitos* ranking, int i) {
+    while (i > 0 && rankingMenor(ranking, ranking->heap[i], ranking->heap[(i - 1) / 2])) {
+        trocarNoHeap(ranking, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+/**
+ * @brief Reposiciona um suspeito cuja pontuação acabou de aumentar.
+ * O heap mínimo guarda os k melhores; como as pontuações só crescem, todo
+ * suspeito fora do heap tem pontuação <= à do topo, e cada atualização custa O(log k).
+ */
+void atualizarRanking(RankingSuspeitos* ranking, int suspeito) {
+    if (ranking->k == 0) return;
+    int pos = ranking->posHeap[suspeito];
+    if (pos >= 0) {
+        descerNoHeap(ranking, pos);
+    } else if (ranking->tamanho < ranking->k) {
+        ranking->heap[ranking->tamanho] = suspeito;
+        ranking->posHeap[suspeito] = ranking->tamanho;
+        subirNoHeap(ranking, ranking->tamanho++);
+    } else if (rankingMenor(ranking, ranking->heap[0], suspeito)) {
+        ranking->posHeap[ranking->heap[0]] = -1;
+        ranking->heap[0] = suspeito;
+        ranking->posHeap[suspeito] = 0;
+        descerNoHeap(ranking, 0);
+    }
+}
+
+/**
+ * @brief Soma os pesos de uma pista coletada às pontuações dos suspeitos ligados a ela.
+ * @return 1 se a pista existe na base, 0 caso contrário.
+ */
+int somarEvidencia(RankingSuspeitos* ranking, const char* pista) {
+    const BaseEvidencias* base = ranking->base;
+    int idPista = buscarNoIndice(&base->pistas, pista);
+    if (idPista < 0) return 0;
+    for (int i = base->inicio[idPista]; i < base->inicio[idPista + 1]; i++) {
+        int s = base->suspeito[i];
+        ranking->pontuacao[s] += base->peso[i];
+        atualizarRanking(ranking, s);
+    }
+    return 1;
+}
+
+/**
+ * @brief Registra uma pista coletada no ranking. Com base recarregável, a pista
+ * também é guardada para ser somada de novo quando outra versão for publicada.
+ */
+int registrarEvidencia(RankingSuspeitos* ranking, const char* pista) {
+    if (ranking->publicacao) {
+        if (ranking->nRegistradas == ranking->capRegistradas) {
+            ranking->capRegistradas = ranking->capRegistradas ? 2 * ranking->capRegistradas : 16;
+            ranking->registradas = (char**) realloc(ranking->registradas, sizeof(char*) * (size_t) ranking->capRegistradas);
+            if (!ranking->registradas) exit(1);
+        }
+        ranking->registradas[ranking->nRegistradas++] = duplicarTexto(pista);
+    }
+    return somarEvidencia(ranking, pista);
+}
+
+/**
+ * @brief Copia os suspeitos do ranking para `destino`, do mais para o menos provável.
+ * Custa O(k log k) e pode ser chamada a qualquer momento da exploração.
+ * @return Quantos suspeitos foram copiados.
+ */
+int obterRanking(const RankingSuspeitos* ranking, int destino[]) {
+    int n = ranking->tamanho;
+    memcpy(destino, ranking->heap, sizeof(int) * (size_t) n);
+    // Ordenação por inserção é suficiente para o k pequeno usado no jogo
+    for (int i = 1; i < n; i++) {
+        int atual = destino[i], j = i - 1;
+        while (j >= 0 && rankingMenor(ranking, destino[j], atual)) {
+            destino[j + 1] = destino[j];
+            j--;
+        }
+        destino[j + 1] = atual;
+    }
+    return n;
+}
+
+/**
+ * @brief Exibe os suspeitos mais prováveis e suas pontuações acumuladas.
+ */
+void exibirRanking(const RankingSuspeitos* ranking) {
+    int* ordem = (int*) malloc(sizeof(int) * ((size_t) ranking->k + 1)); // O heap guarda até k suspeitos
+    if (!ordem) exit(1);
+    int n = obterRanking(ranking, ordem);
+    int exibidos = 0;
+    printf("Suspeitos mais provaveis:\n");
+    for (int i = 0; i < n; i++) {
+        if (ranking->pontuacao[ordem[i]] <= 0) break;
+        printf("%d. %s (%.1f pontos)\n", i + 1, ranking->base->suspeitos.textos[ordem[i]], ranking->pontuacao[ordem[i]]);
+        exibidos++;
+    }
+    if (exibidos == 0) {
+        printf("- Nenhuma evidencia ainda.\n");
+    }
+    free(ordem);
+}
+
+void liberarRanking(RankingSuspeitos* ranking) {
+    if (!ranking) return;
+    for (int i = 0; i < ranking->nRegistradas; i++) free(ranking->registradas[i]);
+    free(ranking->registradas);
+    liberarLeitorBase(ranking->publicacao, ranking->leitor);
+    free(ranking->pontuacao);
+    free(ranking->posHeap);
+    free(ranking->heap);
+    free(ranking);
+}
+
 // --- Funções Auxiliares e de Limpeza ---
 
 /**
@@ -259,61 +1358,105 @@ unsigned int hashFunction(const char* str) {
     return hash % HASH_SIZE;
 }
 
-/**
- * @brief Simula uma base de dados que associa pistas a suspeitos.
- */
-const char* getSuspeitoParaPista(const char* pista) {
-    if (strcmp(pista, "Um candelabro de prata polido, fora do lugar.") == 0) return "Mordomo";
-    if (strcmp(pista, "Pegadas de sapatos caros na lama.") == 0) return "Dama_da_noite";
-    if (strcmp(pista, "Uma faca de cozinha faltando no conjunto.") == 0) return "Cozinheira";
-    if (strcmp(pista, "Uma carta de ameaca enderecada a vitima.") == 0) return "Dama_da_noite";
-    if (strcmp(pista, "Um livro sobre venenos com uma pagina marcada.") == 0) return "Mordomo";
-    return NULL; // Pista sem suspeito claro
+typedef struct {
+    HashNode** tabelaHash;
+    const char* suspeito;
+    int total;
+} ContextoContagem;
+
+void visitaContarSuspeito(PistaNode* node, void* contexto) {
+    ContextoContagem* contagem = (ContextoContagem*) contexto;
+    const char* suspeitoEncontrado = encontrarSuspeito(contagem->tabelaHash, node->pista);
+    if (suspeitoEncontrado && strcmp(suspeitoEncontrado, contagem->suspeito) == 0) {
+        contagem->total++;
+    }
 }
 
 /**
- * @brief Conta recursivamente quantas pistas na BST apontam para um suspeito específico.
+ * @brief Conta quantas pistas na BST apontam para um suspeito específico.
  */
 int contarPistasParaSuspeito(PistaNode* raizPistas, HashNode* tabelaHash[], const char* suspeito) {
-    if (raizPistas == NULL) {
-        return 0;
-    }
+    ContextoContagem contagem = { tabelaHash, suspeito, 0 };
+    percorrerEmOrdem(raizPistas, visitaContarSuspeito, &contagem);
+    return contagem.total;
+}
 
-    int count = 0;
-    const char* suspeitoEncontrado = encontrarSuspeito(tabelaHash, raizPistas->pista);
+typedef struct {
+    FILE* saida;
+    char buffer[TAM_BUFFER_SAIDA];
+    size_t usado;
+} ContextoEscrita;
 
-    if (suspeitoEncontrado && strcmp(suspeitoEncontrado, suspeito) == 0) {
-        count = 1;
+void visitaEscrever(PistaNode* node, void* contexto) {
+    ContextoEscrita* escrita = (ContextoEscrita*) contexto;
+    size_t tamanho = strlen(node->pista);
+    // "- " + pista + "\n" sempre cabe, pois a pista tem menos de 100 caracteres
+    if (escrita->usado + tamanho + 3 > TAM_BUFFER_SAIDA) {
+        fwrite(escrita->buffer, 1, escrita->usado, escrita->saida);
+        escrita->usado = 0;
     }
+    escrita->buffer[escrita->usado++] = '-';
+    escrita->buffer[escrita->usado++] = ' ';
+    memcpy(escrita->buffer + escrita->usado, node->pista, tamanho);
+    escrita->usado += tamanho;
+    escrita->buffer[escrita->usado++] = '\n';
+}
 
-    return count + contarPistasParaSuspeito(raizPistas->esquerda, tabelaHash, suspeito) +
-           contarPistasParaSuspeito(raizPistas->direita, tabelaHash, suspeito);
+/**
+ * @brief Escreve as pistas da BST em ordem alfabética, agrupando a saída em
+ * blocos de TAM_BUFFER_SAIDA bytes em vez de uma chamada de E/S por pista.
+ */
+void escreverPistas(FILE* saida, PistaNode* raiz) {
+    ContextoEscrita* escrita = (ContextoEscrita*) malloc(sizeof(ContextoEscrita));
+    if (!escrita) exit(1);
+    escrita->saida = saida;
+    escrita->usado = 0;
+    percorrerEmOrdem(raiz, visitaEscrever, escrita);
+    fwrite(escrita->buffer, 1, escrita->usado, saida);
+    free(escrita);
 }
 
 /**
  * @brief Exibe as pistas da BST em ordem alfabética (percurso em ordem).
  */
 void exibirPistas(PistaNode* raiz) {
-    if (raiz != NULL) {
-        exibirPistas(raiz->esquerda);
-        printf("- %s\n", raiz->pista);
-        exibirPistas(raiz->direita);
-    }
+    escreverPistas(stdout, raiz);
 }
 
+/**
+ * @brief Libera o mapa sem recursão: rotaciona à direita enquanto houver filho
+ * esquerdo e libera o nó quando ele não tem mais sub-árvore esquerda.
+ */
 void liberarMapa(Sala* sala) {
-    if (sala) {
-        liberarMapa(sala->esquerda);
-        liberarMapa(sala->direita);
-        free(sala);
+    while (sala) {
+        if (sala->esquerda) {
+            Sala* esquerda = sala->esquerda;
+            sala->esquerda = esquerda->direita;
+            esquerda->direita = sala;
+            sala = esquerda;
+        } else {
+            Sala* direita = sala->direita;
+            free(sala);
+            sala = direita;
+        }
     }
 }
 
-void liberarPistas(PistaNode* raiz) {
-    if (raiz) {
-        liberarPistas(raiz->esquerda);
-        liberarPistas(raiz->direita);
-        free(raiz);
+/**
+ * @brief Libera a BST de pistas sem recursão (mesma técnica de liberarMapa).
+ */
+void liberarPistas(PistaNode* raiz) {
+    while (raiz) {
+        if (raiz->esquerda) {
+            PistaNode* esquerda = raiz->esquerda;
+            raiz->esquerda = esquerda->direita;
+            esquerda->direita = raiz;
+            raiz = esquerda;
+        } else {
+            PistaNode* direita = raiz->direita;
+            free(raiz);
+            raiz = direita;
+        }
     }
 }
 
@@ -326,4 +1469,3307 @@ void liberarHash(HashNode* tabela[]) {
             atual = proximo;
         }
     }
-}
\ No newline at end of file
+}
+
+// --- Gerador Procedural de Mansões ---
+
+/**
+ * @brief Número aleatório associado a um índice (gerador baseado em contador).
+ * Depende só de (semente, fluxo, indice), então o resultado é o mesmo em
+ * qualquer ordem de execução e com qualquer número de threads.
+ */
+uint64_t aleatorioDoIndice(uint64_t semente, uint64_t fluxo, uint64_t indice) {
+    uint64_t estado = semente ^ (fluxo * 0xD1B54A32D192ED03ull) ^ (indice * 0x9E3779B97F4A7C15ull);
+    return proximoAleatorio(&estado);
+}
+
+/**
+ * @brief Segundos de relógio de parede (mede corretamente trechos paralelos).
+ */
+double relogioParede(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Converte o nome de uma forma ("balanceada", "enviesada", "aleatoria").
+ * @return A forma correspondente, ou -1 se o nome for desconhecido.
+ */
+int formaPorNome(const char* nome) {
+    for (int f = 0; f < NUM_FORMAS_MANSAO; f++) {
+        if (strcmp(nome, NOMES_FORMAS_MANSAO[f]) == 0) return f;
+    }
+    return -1;
+}
+
+MansaoGerada* alocarMansaoGerada(uint32_t nSalas, uint32_t nSuspeitos, uint64_t semente, int forma) {
+    MansaoGerada* mansao = (MansaoGerada*) malloc(sizeof(MansaoGerada));
+    if (!mansao) exit(1);
+    mansao->nSalas = nSalas;
+    mansao->nSuspeitos = nSuspeitos > 0 ? nSuspeitos : 1;
+    mansao->semente = semente;
+    mansao->forma = forma;
+    mansao->esquerda = (int32_t*) malloc(sizeof(int32_t) * ((size_t) nSalas + 1));
+    mansao->direita = (int32_t*) malloc(sizeof(int32_t) * ((size_t) nSalas + 1));
+    mansao->suspeito = (int32_t*) malloc(sizeof(int32_t) * ((size_t) nSalas + 1));
+    if (!mansao->esquerda || !mansao->direita || !mansao->suspeito) exit(1);
+    return mansao;
+}
+
+/**
+ * @brief Preenche as ligações de uma sub-árvore aleatória numerada em pré-ordem:
+ * a sala `inicio` é a raiz, a sub-árvore esquerda ocupa as `L` salas seguintes
+ * e a direita o restante. `L` é sorteado pela própria sala, o que torna o
+ * resultado independente da divisão do trabalho entre threads.
+ */
+void gerarSubarvoreAleatoria(MansaoGerada* mansao, uint32_t inicio, uint32_t tamanho) {
+    size_t capacidade = 64, topo = 0;
+    uint32_t (*pilha)[2] = malloc(sizeof(*pilha) * capacidade);
+    if (!pilha) exit(1);
+    for (;;) {
+        while (tamanho > 0) {
+            uint32_t tamEsquerda = (uint32_t) (aleatorioDoIndice(mansao->semente, 1, inicio) % tamanho);
+            uint32_t tamDireita = tamanho - 1 - tamEsquerda;
+            mansao->esquerda[inicio] = tamEsquerda ? (int32_t) (inicio + 1) : -1;
+            mansao->direita[inicio] = tamDireita ? (int32_t) (inicio + 1 + tamEsquerda) : -1;
+            if (tamDireita) {
+                if (topo == capacidade) {
+                    capacidade *= 2;
+                    pilha = realloc(pilha, sizeof(*pilha) * capacidade);
+                    if (!pilha) exit(1);
+                }
+                pilha[topo][0] = inicio + 1 + tamEsquerda;
+                pilha[topo][1] = tamDireita;
+                topo++;
+            }
+            inicio = inicio + 1;
+            tamanho = tamEsquerda;
+        }
+        if (topo == 0) break;
+        topo--;
+        inicio = pilha[topo][0];
+        tamanho = pilha[topo][1];
+    }
+    free(pilha);
+}
+
+/**
+ * @brief Gera de forma determinística uma mansão com `nSalas` salas.
+ *
+ * - balanceada: árvore completa em ordem de nível (filhos de i: 2i+1 e 2i+2);
+ * - enviesada: um único caminho, cada sala sorteia se a próxima fica à esquerda ou à direita;
+ * - aleatoria: cada sala sorteia o tamanho da sua sub-árvore esquerda.
+ *
+ * Cerca de PERCENTUAL_SALAS_COM_PISTA% das salas recebem uma pista, ligada a um
+ * suspeito sorteado. O trabalho é dividido entre threads com OpenMP (quando
+ * compilado com -fopenmp); a mesma semente sempre produz a mesma mansão.
+ */
+MansaoGerada* gerarMansao(uint32_t nSalas, int forma, uint64_t semente, uint32_t nSuspeitos) {
+    MansaoGerada* mansao = alocarMansaoGerada(nSalas, nSuspeitos, semente, forma);
+    int64_t n = nSalas;
+
+    if (forma == FORMA_BALANCEADA) {
+        PARALELO_PARA
+        for (int64_t i = 0; i < n; i++) {
+            mansao->esquerda[i] = 2 * i + 1 < n ? (int32_t) (2 * i + 1) : -1;
+            mansao->direita[i] = 2 * i + 2 < n ? (int32_t) (2 * i + 2) : -1;
+        }
+    } else if (forma == FORMA_ENVIESADA) {
+        PARALELO_PARA
+        for (int64_t i = 0; i < n; i++) {
+            int32_t proxima = i + 1 < n ? (int32_t) (i + 1) : -1;
+            int paraDireita = (int) (aleatorioDoIndice(semente, 1, (uint64_t) i) & 1);
+            mansao->esquerda[i] = paraDireita ? -1 : proxima;
+            mansao->direita[i] = paraDireita ? proxima : -1;
+        }
+    } else {
+        // Divide os níveis de cima sequencialmente até haver trabalho para todas as threads
+        uint32_t corte = nSalas / 4096 > 4096 ? nSalas / 4096 : 4096;
+        size_t capacidade = 8192, total = 0;
+        uint32_t (*intervalos)[2] = malloc(sizeof(*intervalos) * capacidade);
+        uint32_t (*proximos)[2] = malloc(sizeof(*proximos) * capacidade);
+        if (!intervalos || !proximos) exit(1);
+        if (nSalas > 0) {
+            intervalos[0][0] = 0;
+            intervalos[0][1] = nSalas;
+            total = 1;
+        }
+        int dividiu = 1;
+        while (dividiu && total * 2 <= capacidade) {
+            size_t novos = 0;
+            dividiu = 0;
+            for (size_t t = 0; t < total; t++) {
+                uint32_t inicio = intervalos[t][0], tamanho = intervalos[t][1];
+                if (tamanho <= corte) {
+                    proximos[novos][0] = inicio;
+                    proximos[novos++][1] = tamanho;
+                    continue;
+                }
+                uint32_t tamEsquerda = (uint32_t) (aleatorioDoIndice(semente, 1, inicio) % tamanho);
+                uint32_t tamDireita = tamanho - 1 - tamEsquerda;
+                mansao->esquerda[inicio] = tamEsquerda ? (int32_t) (inicio + 1) : -1;
+                mansao->direita[inicio] = tamDireita ? (int32_t) (inicio + 1 + tamEsquerda) : -1;
+                if (tamEsquerda) {
+                    proximos[novos][0] = inicio + 1;
+                    proximos[novos++][1] = tamEsquerda;
+                }
+                if (tamDireita) {
+                    proximos[novos][0] = inicio + 1 + tamEsquerda;
+                    proximos[novos++][1] = tamDireita;
+                }
+                dividiu = 1;
+            }
+            uint32_t (*troca)[2] = intervalos;
+            intervalos = proximos;
+            proximos = troca;
+            total = novos;
+        }
+        int64_t nIntervalos = (int64_t) total;
+        PARALELO_PARA_DINAMICO
+        for (int64_t t = 0; t < nIntervalos; t++) {
+            gerarSubarvoreAleatoria(mansao, intervalos[t][0], intervalos[t][1]);
+        }
+        free(intervalos);
+        free(proximos);
+    }
+
+    PARALELO_PARA
+    for (int64_t i = 0; i < n; i++) {
+        uint64_t sorteio = aleatorioDoIndice(semente, 2, (uint64_t) i);
+        mansao->suspeito[i] = (sorteio % 100) < PERCENTUAL_SALAS_COM_PISTA
+            ? (int32_t) ((sorteio >> 8) % mansao->nSuspeitos) : -1;
+    }
+    return mansao;
+}
+
+void nomeSalaGerada(uint32_t sala, char* destino, size_t tamanho) {
+    snprintf(destino, tamanho, "Sala %u", sala);
+}
+
+void pistaSalaGerada(uint32_t sala, char* destino, size_t tamanho) {
+    snprintf(destino, tamanho, "Pista %u", sala);
+}
+
+void nomeSuspeitoGerado(uint32_t suspeito, char* destino, size_t tamanho) {
+    snprintf(destino, tamanho, "Suspeito_%u", suspeito);
+}
+
+/**
+ * @brief Cria a árvore de Salas (o mesmo formato usado pelo jogo) de uma mansão gerada.
+ * Libere com liberarMapa().
+ */
+Sala* construirSalasGeradas(const MansaoGerada* mansao) {
+    if (mansao->nSalas == 0) return NULL;
+    Sala** salas = (Sala**) malloc(sizeof(Sala*) * mansao->nSalas);
+    if (!salas) exit(1);
+    char nome[50], pista[100];
+    for (uint32_t i = 0; i < mansao->nSalas; i++) {
+        nomeSalaGerada(i, nome, sizeof(nome));
+        pista[0] = '\0';
+        if (mansao->suspeito[i] >= 0) pistaSalaGerada(i, pista, sizeof(pista));
+        salas[i] = criarSala(nome, pista);
+    }
+    for (uint32_t i = 0; i < mansao->nSalas; i++) {
+        if (mansao->esquerda[i] >= 0) salas[i]->esquerda = salas[mansao->esquerda[i]];
+        if (mansao->direita[i] >= 0) salas[i]->direita = salas[mansao->direita[i]];
+    }
+    Sala* raiz = salas[0];
+    free(salas);
+    return raiz;
+}
+
+/**
+ * @brief Monta a base de evidências de uma mansão gerada: cada pista aponta para
+ * o suspeito sorteado (peso 1) e, em metade dos casos, para um segundo suspeito (peso 0.5).
+ */
+BaseEvidencias* criarBaseGerada(const MansaoGerada* mansao) {
+    size_t maxLigacoes = (size_t) mansao->nSalas * 2 + 1;
+    AssociacaoPista* associacoes = (AssociacaoPista*) malloc(sizeof(AssociacaoPista) * maxLigacoes);
+    char (*pistas)[24] = malloc(sizeof(*pistas) * ((size_t) mansao->nSalas + 1));
+    char (*suspeitos)[24] = malloc(sizeof(*suspeitos) * mansao->nSuspeitos);
+    if (!associacoes || !pistas || !suspeitos) exit(1);
+    for (uint32_t s = 0; s < mansao->nSuspeitos; s++) {
+        nomeSuspeitoGerado(s, suspeitos[s], sizeof(suspeitos[s]));
+    }
+
+    int n = 0;
+    for (uint32_t i = 0; i < mansao->nSalas; i++) {
+        if (mansao->suspeito[i] < 0) continue;
+        pistaSalaGerada(i, pistas[i], sizeof(pistas[i]));
+        associacoes[n].pista = pistas[i];
+        associacoes[n].suspeito = suspeitos[mansao->suspeito[i]];
+        associacoes[n++].peso = 1.0f;
+        uint64_t sorteio = aleatorioDoIndice(mansao->semente, 3, i);
+        if (sorteio & 1) {
+            associacoes[n].pista = pistas[i];
+            associacoes[n].suspeito = suspeitos[(sorteio >> 1) % mansao->nSuspeitos];
+            associacoes[n++].peso = 0.5f;
+        }
+    }
+
+    BaseEvidencias* base = criarBaseEvidencias(associacoes, n);
+    free(suspeitos);
+    free(pistas);
+    free(associacoes);
+    return base;
+}
+
+/**
+ * @brief Grava a mansão em disco: cabeçalho seguido dos vetores esquerda,
+ * direita e suspeito (int32 na ordem de bytes da máquina).
+ * @return 1 em caso de sucesso, 0 em caso de erro de E/S.
+ */
+int salvarMansao(const MansaoGerada* mansao, const char* caminho) {
+    FILE* arquivo = fopen(caminho, "wb");
+    if (!arquivo) return 0;
+    CabecalhoMansao cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, MAGICA_MANSAO, 4);
+    cabecalho.versao = 1;
+    cabecalho.nSalas = mansao->nSalas;
+    cabecalho.nSuspeitos = mansao->nSuspeitos;
+    cabecalho.forma = (uint32_t) mansao->forma;
+    cabecalho.semente = mansao->semente;
+    size_t n = mansao->nSalas;
+    int ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1
+          && fwrite(mansao->esquerda, sizeof(int32_t), n, arquivo) == n
+          && fwrite(mansao->direita, sizeof(int32_t), n, arquivo) == n
+          && fwrite(mansao->suspeito, sizeof(int32_t), n, arquivo) == n;
+    if (fclose(arquivo) != 0) ok = 0;
+    return ok;
+}
+
+/**
+ * @brief Lê uma mansão gravada por salvarMansao().
+ * @return A mansão, ou NULL se o arquivo não existir ou for inválido.
+ */
+MansaoGerada* carregarMansao(const char* caminho) {
+    FILE* arquivo = fopen(caminho, "rb");
+    if (!arquivo) return NULL;
+    CabecalhoMansao cabecalho;
+    if (fread(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1
+        || memcmp(cabecalho.magica, MAGICA_MANSAO, 4) != 0 || cabecalho.versao != 1
+        || cabecalho.nSalas == 0 || cabecalho.nSalas > MAX_SALAS_MANSAO
+        || cabecalho.nSuspeitos == 0 || cabecalho.nSuspeitos > MAX_SUSPEITOS_MANSAO) {
+        fclose(arquivo);
+        return NULL;
+    }
+    MansaoGerada* mansao = alocarMansaoGerada(cabecalho.nSalas, cabecalho.nSuspeitos,
+                                              cabecalho.semente, (int) cabecalho.forma);
+    size_t n = mansao->nSalas;
+    int ok = fread(mansao->esquerda, sizeof(int32_t), n, arquivo) == n
+          && fread(mansao->direita, sizeof(int32_t), n, arquivo) == n
+          && fread(mansao->suspeito, sizeof(int32_t), n, arquivo) == n;
+    fclose(arquivo);
+    // Filhos sempre têm índice maior que o pai, o que também impede ciclos, e cada
+    // sala é filha de no máximo uma outra: assim a mansão é de fato uma árvore
+    uint64_t* comPai = criarConjuntoBits((uint32_t) n);
+    for (size_t i = 0; ok && i < n; i++) {
+        int32_t filhos[2] = { mansao->esquerda[i], mansao->direita[i] };
+        for (int lado = 0; ok && lado < 2; lado++) {
+            if (filhos[lado] == -1) continue;
+            ok = (size_t) filhos[lado] > i && (size_t) filhos[lado] < n && !testarBit(comPai, (uint32_t) filhos[lado]);
+            if (ok) marcarBit(comPai, (uint32_t) filhos[lado]);
+        }
+        ok = ok && mansao->suspeito[i] >= -1 && mansao->suspeito[i] < (int32_t) mansao->nSuspeitos;
+    }
+    free(comPai);
+    if (!ok) {
+        liberarMansaoGerada(mansao);
+        return NULL;
+    }
+    return mansao;
+}
+
+void liberarMansaoGerada(MansaoGerada* mansao) {
+    if (!mansao) return;
+    free(mansao->esquerda);
+    free(mansao->direita);
+    free(mansao->suspeito);
+    free(mansao);
+}
+
+/**
+ * @brief Modo de linha de comando: ./mestre --gerar <forma> <salas> <semente> <arquivo> [suspeitos]
+ */
+int executarGerador(int argc, char* argv[]) {
+    if (argc < 6) {
+        printf("Uso: %s --gerar <balanceada|enviesada|aleatoria> <salas> <semente> <arquivo> [suspeitos]\n", argv[0]);
+        return 1;
+    }
+    int forma = formaPorNome(argv[2]);
+    long long nSalas = atoll(argv[3]);
+    long long nSuspeitos = argc > 6 ? atoll(argv[6]) : 1000;
+    if (forma < 0 || nSalas < 1 || nSalas > MAX_SALAS_MANSAO || nSuspeitos < 1 || nSuspeitos > MAX_SUSPEITOS_MANSAO) {
+        printf("Forma ou quantidade de salas ou suspeitos invalida (ate %d salas e %d suspeitos).\n",
+               MAX_SALAS_MANSAO, MAX_SUSPEITOS_MANSAO);
+        return 1;
+    }
+    uint64_t semente = strtoull(argv[4], NULL, 10);
+
+    double inicio = relogioParede();
+    MansaoGerada* mansao = gerarMansao((uint32_t) nSalas, forma, semente, (uint32_t) nSuspeitos);
+    printf("Mansao %s com %lld salas gerada em %.3fs\n", argv[2], nSalas, relogioParede() - inicio);
+
+    inicio = relogioParede();
+    int ok = salvarMansao(mansao, argv[5]);
+    liberarMansaoGerada(mansao);
+    if (!ok) {
+        printf("Erro ao gravar %s\n", argv[5]);
+        return 1;
+    }
+    printf("Gravada em %s em %.3fs\n", argv[5], relogioParede() - inicio);
+    return 0;
+}
+
+// --- Mapa em Grafo (CSR) e Conjuntos de Bits ---
+
+/**
+ * @brief Aloca um conjunto de bits zerado com espaço para `n` elementos.
+ */
+uint64_t* criarConjuntoBits(uint32_t n) {
+    uint64_t* bits = (uint64_t*) calloc(((size_t) n + 63) / 64 + 1, sizeof(uint64_t));
+    if (!bits) exit(1);
+    return bits;
+}
+
+int testarBit(const uint64_t* bits, uint32_t i) {
+    return (int) ((bits[i >> 6] >> (i & 63)) & 1u);
+}
+
+void marcarBit(uint64_t* bits, uint32_t i) {
+    bits[i >> 6] |= (uint64_t) 1 << (i & 63);
+}
+
+/**
+ * @brief Reserva em um único bloco os vetores de um mapa com `nSalas` salas,
+ * `nSaidas` saídas e `tamTextos` bytes de texto. O chamador preenche os vetores
+ * devolvidos e o mapa é liberado de uma vez por liberarMapaGrafo().
+ */
+MapaGrafo* alocarMapaGrafo(uint32_t nSalas, size_t nSaidas, size_t tamTextos,
+                           uint32_t** inicio, uint32_t** destino, uint32_t** nome, uint32_t** pista, char** textos) {
+    size_t bytesIndices = sizeof(uint32_t) * (3 * (size_t) nSalas + 1 + nSaidas);
+    MapaGrafo* mapa = (MapaGrafo*) malloc(sizeof(MapaGrafo));
+    char* memoria = (char*) malloc(bytesIndices + tamTextos + 1);
+    if (!mapa || !memoria) exit(1);
+    *inicio = (uint32_t*) memoria;
+    *nome = *inicio + nSalas + 1;
+    *pista = *nome + nSalas;
+    *destino = *pista + nSalas;
+    *textos = memoria + bytesIndices;
+    (*textos)[0] = '\0'; // Deslocamento 0 é o texto vazio (sala sem pista)
+
+    mapa->nSalas = nSalas;
+    mapa->inicio = *inicio;
+    mapa->destino = *destino;
+    mapa->nome = *nome;
+    mapa->pista = *pista;
+    mapa->textos = *textos;
+    mapa->memoria = memoria;
+    mapa->simbolos = NULL;
+    return mapa;
+}
+
+/**
+ * @brief Converte a árvore de Salas em um mapa CSR (salas numeradas em largura,
+ * a partir do Hall = 0). A primeira saída é a esquerda e a segunda a direita;
+ * se só houver saída à direita, a esquerda fica marcada como SEM_SALA.
+ */
+MapaGrafo* mapaDeArvore(const Sala* raiz) {
+    // Fila em largura; ao final ela contém todas as salas na ordem dos ids
+    size_t capacidade = 64, total = 0, tamTextos = 1, nSaidas = 0;
+    const Sala** fila = (const Sala**) malloc(sizeof(const Sala*) * capacidade);
+    if (!fila) exit(1);
+    if (raiz) fila[total++] = raiz;
+    for (size_t i = 0; i < total; i++) {
+        const Sala* filhos[2] = { fila[i]->esquerda, fila[i]->direita };
+        tamTextos += strlen(fila[i]->nome) + 1 + (fila[i]->pista[0] ? strlen(fila[i]->pista) + 1 : 0);
+        nSaidas += filhos[1] ? 2 : (filhos[0] ? 1 : 0);
+        for (int f = 0; f < 2; f++) {
+            if (!filhos[f]) continue;
+            if (total == capacidade) {
+                capacidade *= 2;
+                fila = (const Sala**) realloc(fila, sizeof(const Sala*) * capacidade);
+                if (!fila) exit(1);
+            }
+            fila[total++] = filhos[f];
+        }
+    }
+
+    uint32_t *inicio, *destino, *nome, *pista;
+    char* textos;
+    MapaGrafo* mapa = alocarMapaGrafo((uint32_t) total, nSaidas, tamTextos, &inicio, &destino, &nome, &pista, &textos);
+    size_t usado = 1;
+    uint32_t saida = 0, proximoId = 1;
+    for (size_t i = 0; i < total; i++) {
+        const Sala* sala = fila[i];
+        inicio[i] = saida;
+        // Os filhos recebem ids na mesma ordem em que entraram na fila
+        uint32_t idEsquerda = sala->esquerda ? proximoId++ : SEM_SALA;
+        uint32_t idDireita = sala->direita ? proximoId++ : SEM_SALA;
+        if (sala->esquerda || sala->direita) destino[saida++] = idEsquerda;
+        if (sala->direita) destino[saida++] = idDireita;
+
+        nome[i] = (uint32_t) usado;
+        usado += (size_t) sprintf(textos + usado, "%s", sala->nome) + 1;
+        pista[i] = 0;
+        if (sala->pista[0]) {
+            pista[i] = (uint32_t) usado;
+            usado += (size_t) sprintf(textos + usado, "%s", sala->pista) + 1;
+        }
+    }
+    inicio[total] = saida;
+    free(fila);
+    return mapa;
+}
+
+/**
+ * @brief Converte uma mansão gerada em mapa CSR, acrescentando `extras` passagens
+ * sorteadas (escadas, corredores) que criam ciclos. As duas primeiras saídas de
+ * cada sala seguem a convenção esquerda/direita de mapaDeArvore().
+ */
+MapaGrafo* mapaDeMansaoGerada(const MansaoGerada* mansao, uint32_t extras) {
+    uint32_t n = mansao->nSalas;
+    uint32_t* grauExtra = (uint32_t*) calloc((size_t) n + 1, sizeof(uint32_t));
+    if (!grauExtra) exit(1);
+    for (uint32_t x = 0; n > 1 && x < extras; x++) {
+        grauExtra[aleatorioDoIndice(mansao->semente, 4, x) % n]++;
+    }
+
+    size_t nSaidas = 0, tamTextos = 1;
+    char texto[32];
+    for (uint32_t i = 0; i < n; i++) {
+        nSaidas += (mansao->direita[i] >= 0 ? 2 : (mansao->esquerda[i] >= 0 ? 1 : 0)) + grauExtra[i];
+        nomeSalaGerada(i, texto, sizeof(texto));
+        tamTextos += strlen(texto) + 1;
+        if (mansao->suspeito[i] >= 0) {
+            pistaSalaGerada(i, texto, sizeof(texto));
+            tamTextos += strlen(texto) + 1;
+        }
+    }
+
+    uint32_t *inicio, *destino, *nome, *pista;
+    char* textos;
+    MapaGrafo* mapa = alocarMapaGrafo(n, nSaidas, tamTextos, &inicio, &destino, &nome, &pista, &textos);
+    uint32_t saida = 0;
+    size_t usado = 1;
+    for (uint32_t i = 0; i < n; i++) {
+        inicio[i] = saida;
+        if (mansao->esquerda[i] >= 0 || mansao->direita[i] >= 0) {
+            destino[saida++] = mansao->esquerda[i] >= 0 ? (uint32_t) mansao->esquerda[i] : SEM_SALA;
+        }
+        if (mansao->direita[i] >= 0) destino[saida++] = (uint32_t) mansao->direita[i];
+        saida += grauExtra[i]; // Reservado para as passagens extras
+
+        nome[i] = (uint32_t) usado;
+        nomeSalaGerada(i, textos + usado, tamTextos - usado);
+        usado += strlen(textos + usado) + 1;
+        pista[i] = 0;
+        if (mansao->suspeito[i] >= 0) {
+            pista[i] = (uint32_t) usado;
+            pistaSalaGerada(i, textos + usado, tamTextos - usado);
+            usado += strlen(textos + usado) + 1;
+        }
+    }
+    inicio[n] = saida;
+
+    // Preenche as passagens extras de trás para frente em cada sala (mesmo sorteio da contagem)
+    for (uint32_t x = 0; n > 1 && x < extras; x++) {
+        uint32_t origem = (uint32_t) (aleatorioDoIndice(mansao->semente, 4, x) % n);
+        uint32_t alvo = (uint32_t) (aleatorioDoIndice(mansao->semente, 5, x) % n);
+        destino[inicio[origem + 1] - grauExtra[origem]--] = alvo;
+    }
+    free(grauExtra);
+    return mapa;
+}
+
+void liberarMapaGrafo(MapaGrafo* mapa) {
+    if (!mapa) return;
+    free(mapa->memoria);
+    free((void*) mapa->simbolos);
+    free(mapa);
+}
+
+/**
+ * @brief Percorre em largura todas as salas alcançáveis a partir de `origem`.
+ * O conjunto `visitadas` (criarConjuntoBits) garante que ciclos não causem revisitas.
+ * @return Quantas salas foram alcançadas.
+ */
+uint32_t percorrerLargura(const MapaGrafo* mapa, uint32_t origem, uint64_t* visitadas) {
+    uint32_t* fila = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) mapa->nSalas + 1));
+    if (!fila) exit(1);
+    uint32_t cabeca = 0, cauda = 0;
+    marcarBit(visitadas, origem);
+    fila[cauda++] = origem;
+    while (cabeca < cauda) {
+        uint32_t sala = fila[cabeca++];
+        for (uint32_t s = mapa->inicio[sala]; s < mapa->inicio[sala + 1]; s++) {
+            uint32_t vizinha = mapa->destino[s];
+            if (vizinha != SEM_SALA && !testarBit(visitadas, vizinha)) {
+                marcarBit(visitadas, vizinha);
+                fila[cauda++] = vizinha;
+            }
+        }
+    }
+    free(fila);
+    return cauda;
+}
+
+/**
+ * @brief Suspeito principal de uma pista (primeira ligação na base), ou NULL.
+ */
+const char* suspeitoPrincipal(const BaseEvidencias* base, const char* pista) {
+    int idPista = buscarNoIndice(&base->pistas, pista);
+    if (idPista < 0 || base->inicio[idPista] == base->inicio[idPista + 1]) return NULL;
+    return base->suspeitos.textos[base->suspeito[base->inicio[idPista]]];
+}
+
+/**
+ * @brief Coleta a pista da sala, se ela tiver suspeito na base e ainda não tiver
+ * sido coletada por este detetive. A pista vai para a BST do detetive; a Tabela
+ * Hash e o ranking são compartilhados, então só contam a primeira coleta da equipe.
+ * @return 1 se a pista foi coletada agora.
+ */
+int coletarPista(uint32_t sala, const char* pista, PistaNode** bstPistas, HashNode* tabelaHash[],
+                 RankingSuspeitos* ranking, uint64_t* pistasColetadas) {
+    const char* suspeitoAssociado = pista[0] ? suspeitoPrincipal(ranking->base, pista) : NULL;
+    if (!suspeitoAssociado || testarBit(pistasColetadas, sala)) return 0;
+    marcarBit(pistasColetadas, sala);
+    printf(">>> Pista encontrada: \"%s\" <<<\n", pista);
+    *bstPistas = adicionarPista(*bstPistas, pista);
+    if (encontrarSuspeito(tabelaHash, pista) == NULL) {
+        inserirNaHash(tabelaHash, pista, suspeitoAssociado);
+        registrarEvidencia(ranking, pista);
+    }
+    return 1;
+}
+
+/**
+ * @brief Navega por um mapa em grafo a partir de `origem`. As saídas são numeradas
+ * (1, 2, ...) e 'e'/'d' equivalem às saídas 1 e 2. Cada pista é coletada uma única
+ * vez por detetive, controlada pelo conjunto de bits `pistasColetadas`.
+ * Visitas e coletas são gravadas em `registro` (pode ser NULL). Se `ordem` não for
+ * NULL, 'p' indica a pista pendente alcançável mais próxima e 'x' a mais próxima
+ * ligada a um suspeito; `*ordem` (se ainda NULL, com raiz em `origem`) e os motores
+ * de dicas são criados no primeiro pedido.
+ */
+void explorarMapa(const MapaGrafo* mapa, uint32_t origem, PistaNode** bstPistas, HashNode* tabelaHash[],
+                  RankingSuspeitos* ranking, uint64_t* pistasColetadas, RegistroSessao* registro,
+                  OrdemSalas** ordem) {
+    uint32_t salaAtual = origem, ultimaRegistrada = SEM_SALA;
+    char escolha[16];
+    char nomeSuspeito[50];
+    char texto[TAM_TEXTO_MAPA], pista[TAM_TEXTO_MAPA];
+    MotorDicas* dicas = NULL;
+    MotorDicas* dicasSuspeito = NULL;
+    int suspeitoDicas = -1;
+    while (salaAtual != SEM_SALA) {
+        if (salaAtual != ultimaRegistrada) {
+            registrarEvento(registro, EVENTO_VISITA, salaAtual, 0);
+            ultimaRegistrada = salaAtual;
+        }
+        printf("\n---------------------------------------\n");
+        printf("Voce esta em: %s\n", textoDoMapa(mapa, mapa->nome[salaAtual], texto));
+
+        // Verifica se há uma pista ainda não coletada e a processa (decodificada só aqui)
+        snprintf(pista, sizeof(pista), "%s", textoDoMapa(mapa, mapa->pista[salaAtual], texto));
+        if (coletarPista(salaAtual, pista, bstPistas, tabelaHash, ranking, pistasColetadas)) {
+            registrarEvento(registro, EVENTO_PISTA, salaAtual, 0);
+            if (dicas) marcarPistaPendente(dicas, salaAtual, 0);
+            if (dicasSuspeito) marcarPistaPendente(dicasSuspeito, salaAtual, 0);
+        } else {
+            printf("Nenhuma pista nova neste comodo.\n");
+        }
+
+        uint32_t nSaidas = mapa->inicio[salaAtual + 1] - mapa->inicio[salaAtual];
+        const uint32_t* saidas = mapa->destino + mapa->inicio[salaAtual];
+        for (uint32_t s = 0; s < nSaidas; s++) {
+            if (saidas[s] == SEM_SALA) continue;
+            const char* atalho = s == 0 ? "|e" : (s == 1 ? "|d" : "");
+            printf(" (%u%s) %s\n", s + 1, atalho, textoDoMapa(mapa, mapa->nome[saidas[s]], texto));
+        }
+        printf("Para onde voce quer ir? (numero/e/d/s, r = ranking, p/x = dica): ");
+        if (scanf("%15s", escolha) != 1) break;
+
+        // Ponto seguro: fora de qualquer consulta, a sessão pode adotar uma base recarregada
+        if (sincronizarBase(ranking, tabelaHash)) {
+            printf("(Base de pistas atualizada para a versao %u.)\n", ranking->versaoBase);
+            registrarBaseSessao(registro, ranking->base);
+            liberarMotorDicas(dicas);
+            liberarMotorDicas(dicasSuspeito);
+            dicas = dicasSuspeito = NULL;
+            suspeitoDicas = -1;
+        }
+
+        uint32_t saida = SEM_SALA;
+        switch (escolha[0]) {
+            case 'e': case 'E': saida = 0; break;
+            case 'd': case 'D': saida = 1; break;
+            case 's': case 'S': salaAtual = SEM_SALA; continue; // Sair
+            case 'r': case 'R': exibirRanking(ranking); continue;
+            case 'p': case 'P':
+                if (!ordem) break;
+                if (!*ordem) *ordem = criarOrdemSalas(mapa, origem);
+                if (!dicas) dicas = criarMotorDicasSessao(*ordem, ranking->base, pistasColetadas, -1);
+                exibirDica(mapa, dicas, salaAtual);
+                continue;
+            case 'x': case 'X': {
+                if (!ordem) break;
+                printf("Dica sobre qual suspeito? ");
+                if (scanf("%49s", nomeSuspeito) != 1) break;
+                int suspeito = buscarNoIndice(&ranking->base->suspeitos, nomeSuspeito);
+                if (suspeito < 0) {
+                    printf("Suspeito desconhecido.\n");
+                    continue;
+                }
+                if (!*ordem) *ordem = criarOrdemSalas(mapa, origem);
+                if (suspeito != suspeitoDicas) {
+                    liberarMotorDicas(dicasSuspeito);
+                    dicasSuspeito = criarMotorDicasSessao(*ordem, ranking->base, pistasColetadas, suspeito);
+                    suspeitoDicas = suspeito;
+                }
+                exibirDica(mapa, dicasSuspeito, salaAtual);
+                continue;
+            }
+            default:
+                if (escolha[0] >= '1' && escolha[0] <= '9') saida = (uint32_t) strtoul(escolha, NULL, 10) - 1;
+                break;
+        }
+        if (saida < nSaidas && saidas[saida] != SEM_SALA) {
+            salaAtual = saidas[saida];
+        } else {
+            printf("Caminho bloqueado ou opcao invalida.\n");
+        }
+    }
+    liberarMotorDicas(dicas);
+    liberarMotorDicas(dicasSuspeito);
+}
+
+/**
+ * @brief Modo de linha de comando: ./mestre --jogar <arquivo> [passagens extras]
+ * Joga uma mansão gerada por --gerar, com passagens extras que formam ciclos.
+ */
+int executarMansaoArquivo(int argc, char* argv[], const char* caminhoRegistro) {
+    if (argc < 3) {
+        printf("Uso: %s --jogar <arquivo> [passagens extras]\n", argv[0]);
+        return 1;
+    }
+    MansaoGerada* mansao = carregarMansao(argv[2]);
+    if (!mansao) {
+        printf("Nao foi possivel carregar %s\n", argv[2]);
+        return 1;
+    }
+    MapaGrafo* mapa = mapaDeMansaoGerada(mansao, argc > 3 ? (uint32_t) atol(argv[3]) : 0);
+    compactarTextosMapa(mapa);
+    BaseEvidencias* base = criarBaseGerada(mansao);
+    RankingSuspeitos* ranking = criarRanking(base, TOP_K_SUSPEITOS);
+    uint64_t* pistasColetadas = criarConjuntoBits(mapa->nSalas);
+    HashNode* tabelaHash[HASH_SIZE] = { NULL };
+    PistaNode* bstPistas = NULL;
+
+    RegistroSessao* registro = caminhoRegistro ? abrirRegistroSessao(caminhoRegistro, mapa, base) : NULL;
+    OrdemSalas* ordem = NULL;
+
+    explorarMapa(mapa, 0, &bstPistas, tabelaHash, ranking, pistasColetadas, registro, &ordem);
+    verificarSuspeitoFinal(bstPistas, tabelaHash, ranking, registro);
+
+    fecharRegistroSessao(registro);
+    liberarOrdemSalas(ordem);
+    liberarPistas(bstPistas);
+    liberarHash(tabelaHash);
+    free(pistasColetadas);
+    liberarRanking(ranking);
+    liberarBaseEvidencias(base);
+    liberarMapaGrafo(mapa);
+    liberarMansaoGerada(mansao);
+    return 0;
+}
+
+// --- Índice de Ancestrais (Passeio de Euler + Sparse Table) ---
+
+/**
+ * @brief Monta o índice de ancestrais da árvore de salas alcançáveis a partir de
+ * `raiz` (em mapas com ciclos, usa a árvore da busca em profundidade). O passeio
+ * de Euler registra cada sala ao entrar e ao voltar de cada filho; o LCA de a e b é
+ * a sala de menor profundidade entre suas primeiras ocorrências no passeio.
+ */
+IndiceAncestrais* criarIndiceAncestrais(const MapaGrafo* mapa, uint32_t raiz) {
+    uint32_t n = mapa->nSalas;
+    IndiceAncestrais* indice = (IndiceAncestrais*) malloc(sizeof(IndiceAncestrais));
+    uint32_t* memoria = (uint32_t*) malloc(sizeof(uint32_t) * (3 * (size_t) n + 1));
+    uint32_t* euler = (uint32_t*) malloc(sizeof(uint32_t) * (2 * (size_t) n + 1));
+    uint32_t* pilha = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) n + 1));
+    uint32_t* proximaSaida = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) n + 1));
+    if (!indice || !memoria || !euler || !pilha || !proximaSaida) exit(1);
+    indice->nSalas = n;
+    indice->pai = memoria;
+    indice->profundidade = memoria + n;
+    indice->primeira = memoria + 2 * (size_t) n;
+    for (uint32_t s = 0; s < n; s++) {
+        indice->pai[s] = SEM_SALA;
+        indice->profundidade[s] = UINT32_MAX;
+        indice->primeira[s] = SEM_SALA;
+    }
+
+    // Busca em profundidade iterativa; proximaSaida[s] é o cursor nas saídas de s
+    uint32_t tamanho = 0, topo = 0;
+    if (raiz < n) {
+        indice->profundidade[raiz] = 0;
+        indice->primeira[raiz] = tamanho;
+        euler[tamanho++] = raiz;
+        proximaSaida[raiz] = mapa->inicio[raiz];
+        pilha[topo++] = raiz;
+    }
+    while (topo > 0) {
+        uint32_t sala = pilha[topo - 1];
+        if (proximaSaida[sala] < mapa->inicio[sala + 1]) {
+            uint32_t vizinha = mapa->destino[proximaSaida[sala]++];
+            if (vizinha == SEM_SALA || indice->primeira[vizinha] != SEM_SALA) continue;
+            indice->pai[vizinha] = sala;
+            indice->profundidade[vizinha] = indice->profundidade[sala] + 1;
+            indice->primeira[vizinha] = tamanho;
+            euler[tamanho++] = vizinha;
+            proximaSaida[vizinha] = mapa->inicio[vizinha];
+            pilha[topo++] = vizinha;
+        } else if (--topo > 0) {
+            euler[tamanho++] = pilha[topo - 1]; // Volta ao pai
+        }
+    }
+    free(pilha);
+    free(proximaSaida);
+
+    // Sparse table: nível k guarda a sala mais rasa de euler[i .. i + 2^k)
+    uint32_t niveis = 1;
+    while (tamanho >> niveis) niveis++;
+    indice->tamanhoEuler = tamanho;
+    indice->nNiveis = niveis;
+    indice->logaritmo = (uint8_t*) malloc((size_t) tamanho + 2); // logaritmo[1] existe mesmo sem salas
+    indice->tabela = (uint32_t*) realloc(euler, sizeof(uint32_t) * ((size_t) tamanho * niveis + 1));
+    if (!indice->logaritmo || !indice->tabela) exit(1);
+    indice->logaritmo[0] = indice->logaritmo[1] = 0;
+    for (uint32_t i = 2; i <= tamanho; i++) {
+        indice->logaritmo[i] = (uint8_t) (indice->logaritmo[i / 2] + 1);
+    }
+    for (uint32_t k = 1; k < niveis; k++) {
+        const uint32_t* anterior = indice->tabela + (size_t) (k - 1) * tamanho;
+        uint32_t* atual = indice->tabela + (size_t) k * tamanho;
+        int64_t limite = (int64_t) tamanho - ((int64_t) 1 << k) + 1;
+        uint32_t metade = (uint32_t) 1 << (k - 1);
+        PARALELO_PARA
+        for (int64_t i = 0; i < limite; i++) {
+            uint32_t a = anterior[i], b = anterior[i + metade];
+            atual[i] = indice->profundidade[a] <= indice->profundidade[b] ? a : b;
+        }
+    }
+    return indice;
+}
+
+/**
+ * @brief Ancestral comum mais baixo de `a` e `b` em O(1), ou SEM_SALA se alguma
+ * das salas não foi alcançada a partir da raiz.
+ */
+uint32_t ancestralComum(const IndiceAncestrais* indice, uint32_t a, uint32_t b) {
+    if (a >= indice->nSalas || b >= indice->nSalas) return SEM_SALA;
+    uint32_t i = indice->primeira[a], j = indice->primeira[b];
+    if (i == SEM_SALA || j == SEM_SALA) return SEM_SALA;
+    if (i > j) {
+        uint32_t troca = i;
+        i = j;
+        j = troca;
+    }
+    uint32_t k = indice->logaritmo[j - i + 1];
+    uint32_t x = indice->tabela[(size_t) k * indice->tamanhoEuler + i];
+    uint32_t y = indice->tabela[(size_t) k * indice->tamanhoEuler + j - ((uint32_t) 1 << k) + 1];
+    return indice->profundidade[x] <= indice->profundidade[y] ? x : y;
+}
+
+/**
+ * @brief Indica se `ancestral` está no caminho da raiz até `sala` (inclusive).
+ */
+int ehAncestral(const IndiceAncestrais* indice, uint32_t ancestral, uint32_t sala) {
+    return ancestral != SEM_SALA && ancestralComum(indice, ancestral, sala) == ancestral;
+}
+
+/**
+ * @brief Indica se `sala` fica no caminho entre `a` e `b`.
+ */
+int estaNoCaminho(const IndiceAncestrais* indice, uint32_t a, uint32_t b, uint32_t sala) {
+    uint32_t lca = ancestralComum(indice, a, b);
+    return lca != SEM_SALA && ehAncestral(indice, lca, sala)
+        && (ehAncestral(indice, sala, a) || ehAncestral(indice, sala, b));
+}
+
+/**
+ * @brief Número de passagens entre `a` e `b`, ou SEM_SALA se não há caminho.
+ */
+uint32_t distanciaSalas(const IndiceAncestrais* indice, uint32_t a, uint32_t b) {
+    uint32_t lca = ancestralComum(indice, a, b);
+    if (lca == SEM_SALA) return SEM_SALA;
+    return indice->profundidade[a] + indice->profundidade[b] - 2 * indice->profundidade[lca];
+}
+
+/**
+ * @brief Escreve em `destino` as salas do caminho de `a` até `b` (inclusive),
+ * em O(tamanho do caminho). `destino` precisa de distanciaSalas() + 1 posições.
+ * @return Quantas salas foram escritas (0 se não há caminho).
+ */
+uint32_t caminhoEntreSalas(const IndiceAncestrais* indice, uint32_t a, uint32_t b, uint32_t* destino) {
+    uint32_t lca = ancestralComum(indice, a, b);
+    if (lca == SEM_SALA) return 0;
+    uint32_t subida = indice->profundidade[a] - indice->profundidade[lca];
+    uint32_t descida = indice->profundidade[b] - indice->profundidade[lca];
+    // Sobe de a até o LCA e, do fim para o começo, de b até logo abaixo do LCA
+    for (uint32_t i = 0, sala = a; i <= subida; i++, sala = indice->pai[sala]) {
+        destino[i] = sala;
+    }
+    for (uint32_t i = subida + descida, sala = b; i > subida; i--, sala = indice->pai[sala]) {
+        destino[i] = sala;
+    }
+    return subida + descida + 1;
+}
+
+void liberarIndiceAncestrais(IndiceAncestrais* indice) {
+    if (!indice) return;
+    free(indice->pai); // Bloco com pai, profundidade e primeira ocorrência
+    free(indice->tabela);
+    free(indice->logaritmo);
+    free(indice);
+}
+
+/**
+ * @brief Modo de linha de comando: ./mestre --rota <arquivo> <origem> <destino> [sala]
+ * Mostra o caminho entre duas salas de uma mansão gerada e o ponto em que ele
+ * deixa de subir em direção ao Hall (o ancestral comum). Com `sala`, diz também
+ * se ela fica nesse caminho.
+ */
+int executarRota(int argc, char* argv[]) {
+    if (argc < 5) {
+        printf("Uso: %s --rota <arquivo> <origem> <destino> [sala]\n", argv[0]);
+        return 1;
+    }
+    MansaoGerada* mansao = carregarMansao(argv[2]);
+    if (!mansao) {
+        printf("Nao foi possivel carregar %s\n", argv[2]);
+        return 1;
+    }
+    uint32_t origem = (uint32_t) strtoul(argv[3], NULL, 10);
+    uint32_t destino = (uint32_t) strtoul(argv[4], NULL, 10);
+    uint32_t consultada = argc > 5 ? (uint32_t) strtoul(argv[5], NULL, 10) : 0;
+    if (origem >= mansao->nSalas || destino >= mansao->nSalas || consultada >= mansao->nSalas) {
+        printf("Salas validas: 0 a %u\n", mansao->nSalas - 1);
+        liberarMansaoGerada(mansao);
+        return 1;
+    }
+    MapaGrafo* mapa = mapaDeMansaoGerada(mansao, 0);
+    compactarTextosMapa(mapa);
+    double relogio = relogioParede();
+    IndiceAncestrais* indice = criarIndiceAncestrais(mapa, 0);
+    printf("Indice de ancestrais: %u salas em %.3fs\n", indice->nSalas, relogioParede() - relogio);
+
+    uint32_t distancia = distanciaSalas(indice, origem, destino);
+    uint32_t lca = ancestralComum(indice, origem, destino);
+    uint32_t* caminho = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) distancia + 1));
+    if (!caminho) exit(1);
+    uint32_t tamanho = caminhoEntreSalas(indice, origem, destino, caminho);
+    char textoOrigem[TAM_TEXTO_MAPA], textoDestino[TAM_TEXTO_MAPA], texto[TAM_TEXTO_MAPA];
+    printf("%s -> %s: %u passagem(ns), ancestral comum %s (profundidade %u)\n",
+           textoDoMapa(mapa, mapa->nome[origem], textoOrigem), textoDoMapa(mapa, mapa->nome[destino], textoDestino),
+           distancia, textoDoMapa(mapa, mapa->nome[lca], texto), indice->profundidade[lca]);
+    for (uint32_t i = 0; i < tamanho; i++) {
+        if (i == 20 && tamanho > 40) {
+            printf("  ... (%u salas)\n", tamanho - 40);
+            i = tamanho - 20;
+        }
+        printf("  %s%s\n", textoDoMapa(mapa, mapa->nome[caminho[i]], texto), caminho[i] == lca ? " *" : "");
+    }
+    if (argc > 5) {
+        printf("%s %s no caminho.\n", textoDoMapa(mapa, mapa->nome[consultada], texto),
+               estaNoCaminho(indice, origem, destino, consultada) ? "esta" : "nao esta");
+    }
+
+    free(caminho);
+    liberarIndiceAncestrais(indice);
+    liberarMapaGrafo(mapa);
+    liberarMansaoGerada(mansao);
+    return 0;
+}
+
+// --- Motor de Dicas (pista pendente mais próxima) ---
+
+void iniciarArvoreMinimos(ArvoreMinimos* arvore, uint32_t n) {
+    arvore->folhas = 1;
+    while (arvore->folhas < n) arvore->folhas *= 2;
+    arvore->nos = (NoMinimo*) malloc(sizeof(NoMinimo) * 2 * (size_t) arvore->folhas);
+    if (!arvore->nos) exit(1);
+    for (size_t i = 0; i < 2 * (size_t) arvore->folhas; i++) {
+        arvore->nos[i].valor = SEM_VALOR;
+        arvore->nos[i].sala = SEM_SALA;
+    }
+}
+
+NoMinimo menorNo(NoMinimo a, NoMinimo b) {
+    if (a.valor != b.valor) return a.valor < b.valor ? a : b;
+    return a.sala <= b.sala ? a : b;
+}
+
+/**
+ * @brief Recalcula todos os nós internos a partir das folhas já preenchidas, em O(n).
+ */
+void construirArvoreMinimos(ArvoreMinimos* arvore) {
+    for (uint32_t i = arvore->folhas - 1; i >= 1; i--) {
+        arvore->nos[i] = menorNo(arvore->nos[2 * i], arvore->nos[2 * i + 1]);
+    }
+}
+
+void atualizarArvoreMinimos(ArvoreMinimos* arvore, uint32_t posicao, int64_t valor, uint32_t sala) {
+    size_t i = (size_t) arvore->folhas + posicao;
+    arvore->nos[i].valor = valor;
+    arvore->nos[i].sala = sala;
+    for (i /= 2; i >= 1; i /= 2) {
+        arvore->nos[i] = menorNo(arvore->nos[2 * i], arvore->nos[2 * i + 1]);
+    }
+}
+
+/**
+ * @brief Menor valor nas posições [inicio, fim), percorrendo a árvore de baixo para cima.
+ */
+NoMinimo consultarArvoreMinimos(const ArvoreMinimos* arvore, uint32_t inicio, uint32_t fim) {
+    NoMinimo melhor = { SEM_VALOR, SEM_SALA };
+    size_t l = (size_t) arvore->folhas + inicio, r = (size_t) arvore->folhas + fim;
+    for (; l < r; l /= 2, r /= 2) {
+        if (l & 1) melhor = menorNo(melhor, arvore->nos[l++]);
+        if (r & 1) melhor = menorNo(melhor, arvore->nos[--r]);
+    }
+    return melhor;
+}
+
+/**
+ * @brief Monta a pré-ordem das salas alcançáveis a partir de `raiz` (a mesma da busca
+ * em profundidade do índice de ancestrais). Em um mapa-árvore só se desce pelas
+ * saídas, então as salas alcançáveis a partir de uma sala são exatamente a sua
+ * subárvore: um intervalo contíguo [posicao, posicao + tamanho) da ordem.
+ * A estrutura não muda durante o jogo e pode ser compartilhada por todas as sessões do mapa.
+ */
+OrdemSalas* criarOrdemSalas(const MapaGrafo* mapa, uint32_t raiz) {
+    uint32_t n = mapa->nSalas;
+    OrdemSalas* ordem = (OrdemSalas*) malloc(sizeof(OrdemSalas));
+    uint32_t* memoria = (uint32_t*) malloc(sizeof(uint32_t) * (2 * (size_t) n + 1));
+    if (!ordem || !memoria) exit(1);
+    IndiceAncestrais* indice = criarIndiceAncestrais(mapa, raiz);
+    ordem->mapa = mapa;
+    ordem->indice = indice;
+    ordem->nSalas = n;
+    ordem->posicao = memoria;
+    ordem->tamanho = memoria + n;
+
+    // Pré-ordem = primeiras ocorrências no passeio de Euler
+    uint32_t alcancadas = 0;
+    for (uint32_t s = 0; s < n; s++) {
+        ordem->posicao[s] = SEM_SALA;
+        ordem->tamanho[s] = indice->primeira[s] != SEM_SALA;
+    }
+    for (uint32_t i = 0; i < indice->tamanhoEuler; i++) {
+        uint32_t sala = indice->tabela[i];
+        if (indice->primeira[sala] == i) ordem->posicao[sala] = alcancadas++;
+    }
+    // Tamanhos das subárvores: filhos vêm depois do pai na pré-ordem
+    uint32_t* salaNaPosicao = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) alcancadas + 1));
+    if (!salaNaPosicao) exit(1);
+    for (uint32_t s = 0; s < n; s++) {
+        if (ordem->posicao[s] != SEM_SALA) salaNaPosicao[ordem->posicao[s]] = s;
+    }
+    for (uint32_t i = alcancadas; i-- > 1;) {
+        ordem->tamanho[indice->pai[salaNaPosicao[i]]] += ordem->tamanho[salaNaPosicao[i]];
+    }
+    free(salaNaPosicao);
+
+    // É uma árvore se as salas alcançáveis têm, juntas, exatamente alcancadas - 1 saídas
+    size_t saidas = 0;
+    for (uint32_t s = 0; s < n; s++) {
+        if (ordem->posicao[s] == SEM_SALA) continue;
+        for (uint32_t e = mapa->inicio[s]; e < mapa->inicio[s + 1]; e++) saidas += mapa->destino[e] != SEM_SALA;
+    }
+    ordem->arvore = alcancadas > 0 && saidas == (size_t) alcancadas - 1;
+    return ordem;
+}
+
+void liberarOrdemSalas(OrdemSalas* ordem) {
+    if (!ordem) return;
+    liberarIndiceAncestrais(ordem->indice);
+    free(ordem->posicao); // Bloco com posicao e tamanho
+    free(ordem);
+}
+
+/**
+ * @brief Cria o motor de dicas de uma sessão com as salas marcadas em `pendentes`
+ * (o conjunto é copiado). Em mapas-árvore, a construção é O(n) e coletas e
+ * consultas custam O(log n).
+ */
+MotorDicas* criarMotorDicas(const OrdemSalas* ordem, const uint64_t* pendentes) {
+    uint32_t n = ordem->nSalas;
+    MotorDicas* motor = (MotorDicas*) calloc(1, sizeof(MotorDicas));
+    if (!motor) exit(1);
+    motor->ordem = ordem;
+    motor->pendentes = criarConjuntoBits(n);
+    memcpy(motor->pendentes, pendentes, sizeof(uint64_t) * (((size_t) n + 63) / 64));
+    if (!ordem->arvore) return motor; // Com ciclos, as consultas usam busca em largura
+    iniciarArvoreMinimos(&motor->profundidades, n);
+    for (uint32_t s = 0; s < n; s++) {
+        uint32_t posicao = ordem->posicao[s];
+        if (posicao != SEM_SALA && testarBit(pendentes, s)) {
+            motor->profundidades.nos[motor->profundidades.folhas + posicao].valor = ordem->indice->profundidade[s];
+            motor->profundidades.nos[motor->profundidades.folhas + posicao].sala = s;
+        }
+    }
+    construirArvoreMinimos(&motor->profundidades);
+    return motor;
+}
+
+/**
+ * @brief Marca (ou desmarca, quando a pista é coletada) a pista de `sala` como pendente.
+ */
+void marcarPistaPendente(MotorDicas* motor, uint32_t sala, int pendente) {
+    const OrdemSalas* ordem = motor->ordem;
+    if (sala >= ordem->nSalas) return;
+    if (pendente) marcarBit(motor->pendentes, sala);
+    else motor->pendentes[sala >> 6] &= ~((uint64_t) 1 << (sala & 63));
+    if (ordem->arvore && ordem->posicao[sala] != SEM_SALA) {
+        atualizarArvoreMinimos(&motor->profundidades, ordem->posicao[sala],
+                               pendente ? (int64_t) ordem->indice->profundidade[sala] : SEM_VALOR,
+                               pendente ? sala : SEM_SALA);
+    }
+}
+
+/**
+ * @brief Busca em largura pelas saídas reais a partir de `origem` até a primeira
+ * sala pendente (mapas com ciclos). Guarda em `anterior` o caminho encontrado.
+ */
+uint32_t pistaMaisProximaEmLargura(MotorDicas* motor, uint32_t origem, uint32_t* distancia) {
+    const MapaGrafo* mapa = motor->ordem->mapa;
+    uint32_t n = mapa->nSalas;
+    if (!motor->fila) {
+        motor->fila = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) n + 1));
+        motor->anterior = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) n + 1));
+        motor->marca = (uint32_t*) calloc((size_t) n + 1, sizeof(uint32_t));
+        if (!motor->fila || !motor->anterior || !motor->marca) exit(1);
+    }
+    if (++motor->rodada == 0) { // Contador deu a volta: limpa as marcas
+        memset(motor->marca, 0, sizeof(uint32_t) * ((size_t) n + 1));
+        motor->rodada = 1;
+    }
+    uint32_t cabeca = 0, cauda = 0;
+    motor->fila[cauda++] = origem;
+    motor->marca[origem] = motor->rodada;
+    motor->anterior[origem] = SEM_SALA;
+    while (cabeca < cauda) {
+        uint32_t sala = motor->fila[cabeca++];
+        if (testarBit(motor->pendentes, sala)) {
+            uint32_t passos = 0;
+            for (uint32_t x = sala; x != origem; x = motor->anterior[x]) passos++;
+            if (distancia) *distancia = passos;
+            return sala;
+        }
+        for (uint32_t e = mapa->inicio[sala]; e < mapa->inicio[sala + 1]; e++) {
+            uint32_t vizinha = mapa->destino[e];
+            if (vizinha == SEM_SALA || motor->marca[vizinha] == motor->rodada) continue;
+            motor->marca[vizinha] = motor->rodada;
+            motor->anterior[vizinha] = sala;
+            motor->fila[cauda++] = vizinha;
+        }
+    }
+    return SEM_SALA;
+}
+
+/**
+ * @brief Sala com pista pendente mais próxima entre as que o jogador consegue
+ * alcançar a partir de `origem` seguindo as saídas. Em mapas-árvore é a pendente
+ * mais rasa da subárvore de `origem` (mínimo no intervalo da pré-ordem, O(log n)).
+ * @return A sala encontrada (SEM_SALA se não há pendentes alcançáveis); `distancia` recebe as passagens.
+ */
+uint32_t pistaMaisProxima(MotorDicas* motor, uint32_t origem, uint32_t* distancia) {
+    const OrdemSalas* ordem = motor->ordem;
+    if (origem >= ordem->nSalas || ordem->posicao[origem] == SEM_SALA) return SEM_SALA;
+    if (!ordem->arvore) return pistaMaisProximaEmLargura(motor, origem, distancia);
+    NoMinimo melhor = consultarArvoreMinimos(&motor->profundidades, ordem->posicao[origem],
+                                             ordem->posicao[origem] + ordem->tamanho[origem]);
+    if (melhor.sala == SEM_SALA) return SEM_SALA;
+    if (distancia) *distancia = (uint32_t) melhor.valor - ordem->indice->profundidade[origem];
+    return melhor.sala;
+}
+
+/**
+ * @brief Salas de `origem` até `alvo` (inclusive) para a dica recém-calculada por
+ * pistaMaisProxima(). Em mapas-árvore é a descida pela subárvore; com ciclos, o
+ * caminho da última busca em largura.
+ * @return Quantas salas foram escritas em `destino`.
+ */
+uint32_t caminhoDaDica(const MotorDicas* motor, uint32_t origem, uint32_t alvo, uint32_t* destino) {
+    if (motor->ordem->arvore) return caminhoEntreSalas(motor->ordem->indice, origem, alvo, destino);
+    uint32_t tamanho = 0;
+    for (uint32_t x = alvo; x != SEM_SALA; x = x == origem ? SEM_SALA : motor->anterior[x]) destino[tamanho++] = x;
+    for (uint32_t i = 0; i < tamanho / 2; i++) {
+        uint32_t troca = destino[i];
+        destino[i] = destino[tamanho - 1 - i];
+        destino[tamanho - 1 - i] = troca;
+    }
+    return tamanho;
+}
+
+void liberarMotorDicas(MotorDicas* motor) {
+    if (!motor) return;
+    free(motor->pendentes);
+    free(motor->profundidades.nos);
+    free(motor->fila);
+    free(motor->anterior);
+    free(motor->marca);
+    free(motor);
+}
+
+/**
+ * @brief Cria o motor de dicas de uma sessão: salas com pista ainda não coletada
+ * e, se `suspeito` >= 0, apenas as pistas ligadas a esse suspeito na base.
+ */
+MotorDicas* criarMotorDicasSessao(const OrdemSalas* ordem, const BaseEvidencias* base,
+                                  const uint64_t* pistasColetadas, int suspeito) {
+    const MapaGrafo* mapa = ordem->mapa;
+    uint64_t* pendentes = criarConjuntoBits(mapa->nSalas);
+    char texto[TAM_TEXTO_MAPA];
+    for (uint32_t s = 0; s < mapa->nSalas; s++) {
+        if (mapa->pista[s] == 0 || testarBit(pistasColetadas, s)) continue;
+        int idPista = buscarNoIndice(&base->pistas, textoDoMapa(mapa, mapa->pista[s], texto));
+        if (idPista < 0 || base->inicio[idPista] == base->inicio[idPista + 1]) continue;
+        int ligada = suspeito < 0;
+        for (int l = base->inicio[idPista]; !ligada && l < base->inicio[idPista + 1]; l++) {
+            ligada = base->suspeito[l] == suspeito;
+        }
+        if (ligada) marcarBit(pendentes, s);
+    }
+    MotorDicas* motor = criarMotorDicas(ordem, pendentes);
+    free(pendentes);
+    return motor;
+}
+
+/**
+ * @brief Mostra a dica: sala com pista pendente mais próxima e o caminho até ela.
+ */
+void exibirDica(const MapaGrafo* mapa, MotorDicas* motor, uint32_t origem) {
+    uint32_t distancia = 0;
+    uint32_t alvo = pistaMaisProxima(motor, origem, &distancia);
+    if (alvo == SEM_SALA) {
+        printf("Dica: nao ha pistas pendentes alcancaveis daqui.\n");
+        return;
+    }
+    uint32_t* caminho = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) distancia + 1));
+    if (!caminho) exit(1);
+    uint32_t tamanho = caminhoDaDica(motor, origem, alvo, caminho);
+    char texto[TAM_TEXTO_MAPA];
+    printf("Dica: ha uma pista em %s, a %u passagem(ns).", textoDoMapa(mapa, mapa->nome[alvo], texto), distancia);
+    for (uint32_t i = 1; i < tamanho && i <= 8; i++) {
+        printf("%s%s", i == 1 ? " Caminho: " : " -> ", textoDoMapa(mapa, mapa->nome[caminho[i]], texto));
+    }
+    printf("%s\n", tamanho > 9 ? " -> ..." : "");
+    free(caminho);
+}
+
+// --- Textos Compactados (tabela de símbolos) ---
+
+uint64_t ganhoCandidato(const CandidatoSimbolo* candidato) {
+    return (uint64_t) candidato->contagem * candidato->tamanho;
+}
+
+int compararCandidatos(const void* a, const void* b) {
+    const CandidatoSimbolo* x = (const CandidatoSimbolo*) a;
+    const CandidatoSimbolo* y = (const CandidatoSimbolo*) b;
+    uint64_t ganhoX = ganhoCandidato(x), ganhoY = ganhoCandidato(y);
+    if (ganhoX != ganhoY) return ganhoX > ganhoY ? -1 : 1;
+    if (x->tamanho != y->tamanho) return x->tamanho > y->tamanho ? -1 : 1;
+    return memcmp(&x->bytes, &y->bytes, sizeof(uint64_t));
+}
+
+/**
+ * @brief Soma `contagem` ao candidato com os bytes dados (tabela de espalhamento aberta).
+ */
+void contarCandidato(CandidatoSimbolo* tabela, uint32_t mascara, const char* bytes, uint8_t tamanho, uint32_t contagem) {
+    uint64_t chave = 0;
+    memcpy(&chave, bytes, tamanho);
+    uint64_t espalhamento = (chave ^ tamanho) * 0x9E3779B97F4A7C15ull;
+    for (uint32_t i = (uint32_t) (espalhamento >> 40) & mascara;; i = (i + 1) & mascara) {
+        if (tabela[i].tamanho == 0) {
+            tabela[i].bytes = chave;
+            tabela[i].tamanho = tamanho;
+            tabela[i].contagem = contagem;
+            return;
+        }
+        if (tabela[i].tamanho == tamanho && tabela[i].bytes == chave) {
+            tabela[i].contagem += contagem;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Ordena os códigos por byte inicial e, dentro dele, do maior símbolo para
+ * o menor, para que a codificação ache o casamento mais longo primeiro.
+ */
+void indexarTabelaSimbolos(TabelaSimbolos* tabela) {
+    uint16_t contagem[257] = { 0 };
+    for (uint32_t c = 0; c < tabela->nSimbolos; c++) {
+        contagem[(uint8_t) tabela->simbolo[c][0] + 1]++;
+    }
+    for (int b = 0; b < 256; b++) {
+        contagem[b + 1] += contagem[b];
+    }
+    memcpy(tabela->primeiro, contagem, sizeof(contagem));
+    for (int tamanho = 8; tamanho >= 1; tamanho--) {
+        for (uint32_t c = 0; c < tabela->nSimbolos; c++) {
+            if (tabela->tamanho[c] == tamanho) {
+                tabela->ordem[contagem[(uint8_t) tabela->simbolo[c][0]]++] = (uint8_t) c;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Código do maior símbolo que casa com o início de `texto`, ou -1.
+ */
+int casarSimbolo(const TabelaSimbolos* tabela, const char* texto, size_t restante) {
+    uint8_t inicial = (uint8_t) texto[0];
+    for (uint16_t i = tabela->primeiro[inicial]; i < tabela->primeiro[inicial + 1]; i++) {
+        uint8_t codigo = tabela->ordem[i];
+        if (tabela->tamanho[codigo] <= restante && memcmp(tabela->simbolo[codigo], texto, tabela->tamanho[codigo]) == 0) {
+            return codigo;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Treina a tabela de símbolos (no estilo do FSST) sobre uma amostra de textos
+ * separados por '\0'. A cada rodada, a amostra é dividida com a tabela atual e
+ * cada símbolo e cada par de símbolos vizinhos (até 8 bytes) vira candidato; ficam
+ * os MAX_SIMBOLOS candidatos que mais economizam bytes (contagem x tamanho).
+ */
+void treinarTabelaSimbolos(TabelaSimbolos* tabela, const char* amostra, size_t tamanho) {
+    uint32_t capacidade = 1024;
+    while (capacidade < 4 * tamanho + 1024) capacidade *= 2;
+    uint32_t mascara = capacidade - 1;
+    CandidatoSimbolo* candidatos = (CandidatoSimbolo*) malloc(sizeof(CandidatoSimbolo) * capacidade);
+    if (!candidatos) exit(1);
+    tabela->nSimbolos = 0;
+    indexarTabelaSimbolos(tabela);
+
+    for (int rodada = 0; rodada < RODADAS_TREINO_SIMBOLOS; rodada++) {
+        memset(candidatos, 0, sizeof(CandidatoSimbolo) * capacidade);
+        size_t p = 0;
+        while (p < tamanho) {
+            if (amostra[p] == '\0') {
+                p++;
+                continue;
+            }
+            // Símbolo atual (ou byte solto) e, se couber, a junção com o próximo
+            int codigo = casarSimbolo(tabela, amostra + p, tamanho - p);
+            uint8_t tamAtual = codigo >= 0 ? tabela->tamanho[codigo] : 1;
+            contarCandidato(candidatos, mascara, amostra + p, tamAtual, 1);
+            size_t proximo = p + tamAtual;
+            if (proximo < tamanho && amostra[proximo] != '\0') {
+                int codigoProximo = casarSimbolo(tabela, amostra + proximo, tamanho - proximo);
+                uint8_t tamProximo = codigoProximo >= 0 ? tabela->tamanho[codigoProximo] : 1;
+                if (tamAtual + tamProximo <= 8) {
+                    contarCandidato(candidatos, mascara, amostra + p, (uint8_t) (tamAtual + tamProximo), 1);
+                }
+            }
+            p = proximo;
+        }
+
+        // Compacta os candidatos no início do vetor e escolhe os melhores
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < capacidade; i++) {
+            if (candidatos[i].tamanho) candidatos[total++] = candidatos[i];
+        }
+        qsort(candidatos, total, sizeof(CandidatoSimbolo), compararCandidatos);
+        tabela->nSimbolos = total < MAX_SIMBOLOS ? total : MAX_SIMBOLOS;
+        for (uint32_t c = 0; c < tabela->nSimbolos; c++) {
+            memcpy(tabela->simbolo[c], &candidatos[c].bytes, 8);
+            tabela->tamanho[c] = candidatos[c].tamanho;
+        }
+        indexarTabelaSimbolos(tabela);
+    }
+    free(candidatos);
+}
+
+/**
+ * @brief Codifica `texto` em `destino` (até 2 * strlen + 1 bytes): um código por
+ * símbolo, CODIGO_ESCAPE + byte para o que não está na tabela e CODIGO_FIM no final.
+ * @return Bytes escritos.
+ */
+size_t codificarTexto(const TabelaSimbolos* tabela, const char* texto, uint8_t* destino) {
+    size_t restante = strlen(texto), escritos = 0;
+    while (restante > 0) {
+        int codigo = casarSimbolo(tabela, texto, restante);
+        if (codigo >= 0) {
+            destino[escritos++] = (uint8_t) codigo;
+            texto += tabela->tamanho[codigo];
+            restante -= tabela->tamanho[codigo];
+        } else {
+            destino[escritos++] = CODIGO_ESCAPE;
+            destino[escritos++] = (uint8_t) *texto++;
+            restante--;
+        }
+    }
+    destino[escritos++] = CODIGO_FIM;
+    return escritos;
+}
+
+/**
+ * @brief Decodifica um texto em `destino` (truncado em `capacidade` - 1 bytes).
+ * Cada símbolo é copiado com 8 bytes fixos enquanto houver folga no destino.
+ * @return Tamanho do texto decodificado.
+ */
+size_t decodificarTexto(const TabelaSimbolos* tabela, const uint8_t* codigo, char* destino, size_t capacidade) {
+    size_t escritos = 0;
+    for (;; codigo++) {
+        if (*codigo == CODIGO_FIM) break;
+        if (*codigo == CODIGO_ESCAPE) {
+            codigo++;
+            if (escritos + 1 < capacidade) destino[escritos++] = (char) *codigo;
+            continue;
+        }
+        uint8_t tamanho = tabela->tamanho[*codigo];
+        if (escritos + 8 < capacidade) {
+            memcpy(destino + escritos, tabela->simbolo[*codigo], 8);
+            escritos += tamanho;
+        } else {
+            for (uint8_t i = 0; i < tamanho && escritos + 1 < capacidade; i++) {
+                destino[escritos++] = tabela->simbolo[*codigo][i];
+            }
+        }
+    }
+    destino[escritos] = '\0';
+    return escritos;
+}
+
+/**
+ * @brief Bytes ocupados pelos textos em claro de um mapa (nomes, pistas e o texto vazio).
+ */
+size_t tamanhoTextosMapa(const MapaGrafo* mapa) {
+    size_t total = 1;
+    char texto[TAM_TEXTO_MAPA];
+    for (uint32_t s = 0; s < mapa->nSalas; s++) {
+        total += strlen(textoDoMapa(mapa, mapa->nome[s], texto)) + 1;
+        if (mapa->pista[s]) total += strlen(textoDoMapa(mapa, mapa->pista[s], texto)) + 1;
+    }
+    return total;
+}
+
+/**
+ * @brief Troca os textos em claro de um mapa (que seja dono da memória) pela versão
+ * codificada com uma tabela de símbolos treinada nesses mesmos textos. Nomes e
+ * pistas passam a ser deslocamentos nos códigos e só são decodificados por textoDoMapa().
+ * @return Bytes dos textos codificados (0 se o mapa não foi alterado).
+ */
+size_t compactarTextosMapa(MapaGrafo* mapa) {
+    if (!mapa->memoria || mapa->simbolos) return 0;
+    uint32_t n = mapa->nSalas;
+    size_t tamTextos = tamanhoTextosMapa(mapa);
+
+    // Amostra com salas espalhadas pelo mapa inteiro
+    size_t limiteAmostra = tamTextos < TAM_AMOSTRA_TEXTOS ? tamTextos : TAM_AMOSTRA_TEXTOS;
+    size_t passo = tamTextos / limiteAmostra, usados = 0;
+    char* amostra = (char*) malloc(limiteAmostra + 2 * TAM_TEXTO_MAPA);
+    if (!amostra) exit(1);
+    for (uint32_t s = 0; s < n && usados < limiteAmostra; s += (uint32_t) passo) {
+        usados += (size_t) sprintf(amostra + usados, "%s", mapa->textos + mapa->nome[s]) + 1;
+        if (mapa->pista[s]) usados += (size_t) sprintf(amostra + usados, "%s", mapa->textos + mapa->pista[s]) + 1;
+    }
+    TabelaSimbolos* tabela = (TabelaSimbolos*) malloc(sizeof(TabelaSimbolos));
+    if (!tabela) exit(1);
+    treinarTabelaSimbolos(tabela, amostra, usados);
+    free(amostra);
+
+    uint8_t* codigos = (uint8_t*) malloc(2 * tamTextos + 1);
+    if (!codigos) exit(1);
+    uint32_t* nome = (uint32_t*) mapa->nome;
+    uint32_t* pista = (uint32_t*) mapa->pista;
+    size_t tamCodigos = 0;
+    codigos[tamCodigos++] = CODIGO_FIM; // Deslocamento 0 continua sendo o texto vazio
+    for (uint32_t s = 0; s < n; s++) {
+        const char* textoNome = mapa->textos + nome[s];
+        nome[s] = (uint32_t) tamCodigos;
+        tamCodigos += codificarTexto(tabela, textoNome, codigos + tamCodigos);
+        if (pista[s]) {
+            const char* textoPista = mapa->textos + pista[s];
+            pista[s] = (uint32_t) tamCodigos;
+            tamCodigos += codificarTexto(tabela, textoPista, codigos + tamCodigos);
+        }
+    }
+
+    // Os textos ficam no fim do bloco do mapa: basta encolhê-lo e copiar os códigos
+    size_t bytesIndices = (size_t) ((const char*) mapa->textos - (const char*) mapa->memoria);
+    char* memoria = (char*) realloc(mapa->memoria, bytesIndices + tamCodigos);
+    if (!memoria) exit(1);
+    memcpy(memoria + bytesIndices, codigos, tamCodigos);
+    free(codigos);
+    mapa->inicio = (const uint32_t*) memoria;
+    mapa->nome = mapa->inicio + n + 1;
+    mapa->pista = mapa->nome + n;
+    mapa->destino = mapa->pista + n;
+    mapa->textos = memoria + bytesIndices;
+    mapa->memoria = memoria;
+    mapa->simbolos = tabela;
+    return tamCodigos;
+}
+
+/**
+ * @brief Texto em `deslocamento` no mapa. Em mapas compactados, decodifica em
+ * `buffer` (TAM_TEXTO_MAPA bytes); nos demais, devolve o próprio texto.
+ */
+const char* textoDoMapa(const MapaGrafo* mapa, uint32_t deslocamento, char* buffer) {
+    if (!mapa->simbolos) return mapa->textos + deslocamento;
+    decodificarTexto(mapa->simbolos, (const uint8_t*) mapa->textos + deslocamento, buffer, TAM_TEXTO_MAPA);
+    return buffer;
+}
+
+// --- Árvore Sucinta (2 bits por sala, rank/select) ---
+
+int contarUns(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int) ((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/**
+ * @brief Posição do bit 1 de ordem `r` (a partir de 0) dentro da palavra.
+ */
+int selecionarNaPalavra(uint64_t x, uint32_t r) {
+    for (; r > 0; r--) x &= x - 1;
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int posicao = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        posicao++;
+    }
+    return posicao;
+#endif
+}
+
+/**
+ * @brief Codifica a árvore da mansão em largura: a sala de ordem i (Hall = 0) ocupa
+ * os bits 2i (tem esquerda) e 2i+1 (tem direita). O k-ésimo bit 1 corresponde à
+ * sala k, então os filhos saem de rank e o pai de select, ambos em tempo constante.
+ * Se `ordem` não for NULL, recebe o id original de cada sala na ordem em largura.
+ * A mansão deve ser uma árvore (carregarMansao() já rejeita outras); a fila nunca
+ * passa de n salas mesmo assim.
+ */
+ArvoreSucinta* criarArvoreSucinta(const MansaoGerada* mansao, uint32_t* ordem) {
+    uint32_t n = mansao->nSalas;
+    ArvoreSucinta* arvore = (ArvoreSucinta*) malloc(sizeof(ArvoreSucinta));
+    uint32_t* fila = ordem ? ordem : (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) n + 1));
+    if (!arvore || !fila) exit(1);
+    size_t nPalavras = (2 * (size_t) n + 63) / 64 + 1;
+    arvore->nSalas = n;
+    arvore->nBlocos = (uint32_t) ((nPalavras + PALAVRAS_POR_BLOCO - 1) / PALAVRAS_POR_BLOCO);
+    arvore->bits = (uint64_t*) calloc((size_t) arvore->nBlocos * PALAVRAS_POR_BLOCO, sizeof(uint64_t));
+    arvore->rankBloco = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) arvore->nBlocos + 1));
+    arvore->amostraSelect = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) n / UNS_POR_AMOSTRA + 2));
+    if (!arvore->bits || !arvore->rankBloco || !arvore->amostraSelect) exit(1);
+
+    uint32_t cabeca = 0, cauda = 0;
+    if (n > 0) fila[cauda++] = 0;
+    while (cabeca < cauda) {
+        uint32_t i = cabeca, sala = fila[cabeca++];
+        if (mansao->esquerda[sala] >= 0 && cauda < n) {
+            arvore->bits[(2 * (size_t) i) >> 6] |= (uint64_t) 1 << ((2 * i) & 63);
+            fila[cauda++] = (uint32_t) mansao->esquerda[sala];
+        }
+        if (mansao->direita[sala] >= 0 && cauda < n) {
+            arvore->bits[(2 * (size_t) i + 1) >> 6] |= (uint64_t) 1 << ((2 * i + 1) & 63);
+            fila[cauda++] = (uint32_t) mansao->direita[sala];
+        }
+    }
+    if (!ordem) free(fila);
+
+    // Diretório de rank (1s antes de cada bloco) e amostras de select (bloco do 1 de ordem k * UNS_POR_AMOSTRA)
+    uint64_t* inicioAmostra = (uint64_t*) malloc(sizeof(uint64_t) * ((size_t) n / UNS_POR_AMOSTRA + 2));
+    if (!inicioAmostra) exit(1);
+    uint32_t uns = 0, amostras = 0;
+    for (uint32_t b = 0; b < arvore->nBlocos; b++) {
+        arvore->rankBloco[b] = uns;
+        for (uint32_t w = 0; w < PALAVRAS_POR_BLOCO; w++) {
+            size_t indice = (size_t) b * PALAVRAS_POR_BLOCO + w;
+            uint32_t naPalavra = (uint32_t) contarUns(arvore->bits[indice]);
+            while (amostras * UNS_POR_AMOSTRA < uns + naPalavra) {
+                inicioAmostra[amostras] = indice * 64
+                    + (uint64_t) selecionarNaPalavra(arvore->bits[indice], amostras * UNS_POR_AMOSTRA - uns);
+                arvore->amostraSelect[amostras++] = b;
+            }
+            uns += naPalavra;
+        }
+    }
+    arvore->rankBloco[arvore->nBlocos] = uns;
+    arvore->nAmostras = amostras;
+    inicioAmostra[amostras] = (uint64_t) arvore->nBlocos * PALAVRAS_POR_BLOCO * 64;
+
+    // Amostras esparsas: posição explícita de cada 1 (no máximo 64 bits a cada LIMITE_AMOSTRA_DENSA / 512)
+    arvore->esparsa = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) amostras + 1));
+    if (!arvore->esparsa) exit(1);
+    arvore->nPosicoes = 0;
+    for (uint32_t a = 0; a < amostras; a++) {
+        arvore->esparsa[a] = SEM_SALA;
+        if (inicioAmostra[a + 1] - inicioAmostra[a] <= LIMITE_AMOSTRA_DENSA) continue;
+        arvore->esparsa[a] = (uint32_t) arvore->nPosicoes;
+        arvore->nPosicoes += uns - a * UNS_POR_AMOSTRA < UNS_POR_AMOSTRA ? uns - a * UNS_POR_AMOSTRA : UNS_POR_AMOSTRA;
+    }
+    arvore->posicoes = (uint64_t*) malloc(sizeof(uint64_t) * (arvore->nPosicoes + 1));
+    if (!arvore->posicoes) exit(1);
+    for (uint32_t a = 0; a < amostras; a++) {
+        if (arvore->esparsa[a] == SEM_SALA) continue;
+        uint64_t* destino = arvore->posicoes + arvore->esparsa[a];
+        uint32_t faltam = uns - a * UNS_POR_AMOSTRA < UNS_POR_AMOSTRA ? uns - a * UNS_POR_AMOSTRA : UNS_POR_AMOSTRA;
+        for (size_t w = inicioAmostra[a] >> 6; faltam > 0; w++) {
+            uint64_t palavra = arvore->bits[w];
+            if (w == inicioAmostra[a] >> 6) palavra &= ~(((uint64_t) 1 << (inicioAmostra[a] & 63)) - 1);
+            for (; palavra && faltam > 0; palavra &= palavra - 1, faltam--) {
+                *destino++ = w * 64 + (uint64_t) selecionarNaPalavra(palavra, 0);
+            }
+        }
+    }
+    free(inicioAmostra);
+    return arvore;
+}
+
+/**
+ * @brief Quantidade de bits 1 antes da posição `posicao`.
+ */
+uint32_t rankSucinto(const ArvoreSucinta* arvore, size_t posicao) {
+    size_t palavra = posicao >> 6, bloco = palavra / PALAVRAS_POR_BLOCO;
+    uint32_t uns = arvore->rankBloco[bloco];
+    for (size_t w = bloco * PALAVRAS_POR_BLOCO; w < palavra; w++) {
+        uns += (uint32_t) contarUns(arvore->bits[w]);
+    }
+    uint64_t mascara = ((uint64_t) 1 << (posicao & 63)) - 1;
+    return uns + (uint32_t) contarUns(arvore->bits[palavra] & mascara);
+}
+
+/**
+ * @brief Posição do bit 1 de ordem `k` (a partir de 1), em tempo constante: posição
+ * guardada nas amostras esparsas, ou busca binária limitada entre os blocos da
+ * amostra e da seguinte, depois no máximo PALAVRAS_POR_BLOCO palavras.
+ */
+size_t selectSucinto(const ArvoreSucinta* arvore, uint32_t k) {
+    uint32_t amostra = (k - 1) / UNS_POR_AMOSTRA;
+    if (arvore->esparsa[amostra] != SEM_SALA) {
+        return (size_t) arvore->posicoes[arvore->esparsa[amostra] + (k - 1) % UNS_POR_AMOSTRA];
+    }
+    uint32_t bloco = arvore->amostraSelect[amostra];
+    uint32_t ultimo = amostra + 1 < arvore->nAmostras ? arvore->amostraSelect[amostra + 1] : arvore->nBlocos - 1;
+    while (bloco < ultimo) { // Último bloco com rankBloco < k
+        uint32_t meio = bloco + (ultimo - bloco + 1) / 2;
+        if (arvore->rankBloco[meio] < k) bloco = meio;
+        else ultimo = meio - 1;
+    }
+    uint32_t restante = k - arvore->rankBloco[bloco];
+    size_t w = (size_t) bloco * PALAVRAS_POR_BLOCO;
+    for (;; w++) {
+        uint32_t naPalavra = (uint32_t) contarUns(arvore->bits[w]);
+        if (naPalavra >= restante) break;
+        restante -= naPalavra;
+    }
+    return w * 64 + (size_t) selecionarNaPalavra(arvore->bits[w], restante - 1);
+}
+
+/**
+ * @brief Filho esquerdo (lado 0) ou direito (lado 1) da sala, ou SEM_SALA.
+ */
+uint32_t filhoSucinto(const ArvoreSucinta* arvore, uint32_t sala, int lado) {
+    size_t posicao = 2 * (size_t) sala + (size_t) lado;
+    if (!((arvore->bits[posicao >> 6] >> (posicao & 63)) & 1)) return SEM_SALA;
+    return rankSucinto(arvore, posicao) + 1;
+}
+
+/**
+ * @brief Sala de onde se chega a `sala` (SEM_SALA para o Hall).
+ */
+uint32_t paiSucinto(const ArvoreSucinta* arvore, uint32_t sala) {
+    if (sala == 0 || sala >= arvore->nSalas) return SEM_SALA;
+    return (uint32_t) (selectSucinto(arvore, sala) / 2);
+}
+
+size_t bytesArvoreSucinta(const ArvoreSucinta* arvore) {
+    return sizeof(ArvoreSucinta) + sizeof(uint64_t) * (size_t) arvore->nBlocos * PALAVRAS_POR_BLOCO
+         + sizeof(uint32_t) * ((size_t) arvore->nBlocos + 1)
+         + sizeof(uint32_t) * ((size_t) arvore->nSalas / UNS_POR_AMOSTRA + 2)
+         + sizeof(uint32_t) * ((size_t) arvore->nAmostras + 1) + sizeof(uint64_t) * (arvore->nPosicoes + 1);
+}
+
+void liberarArvoreSucinta(ArvoreSucinta* arvore) {
+    if (!arvore) return;
+    free(arvore->bits);
+    free(arvore->rankBloco);
+    free(arvore->amostraSelect);
+    free(arvore->esparsa);
+    free(arvore->posicoes);
+    free(arvore);
+}
+
+/**
+ * @brief Renumera as salas da mansão em largura (Hall = 0), a mesma numeração
+ * da árvore sucinta, para que nomes, pistas e suspeitos sigam os ids sucintos.
+ * Como em criarArvoreSucinta(), a mansão deve ser uma árvore e a fila é limitada a n.
+ */
+void renumerarMansaoEmLargura(MansaoGerada* mansao) {
+    uint32_t n = mansao->nSalas;
+    uint32_t* ordem = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) n + 1));
+    uint32_t* novoId = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) n + 1));
+    int32_t* esquerda = (int32_t*) malloc(sizeof(int32_t) * ((size_t) n + 1));
+    int32_t* direita = (int32_t*) malloc(sizeof(int32_t) * ((size_t) n + 1));
+    int32_t* suspeito = (int32_t*) malloc(sizeof(int32_t) * ((size_t) n + 1));
+    if (!ordem || !novoId || !esquerda || !direita || !suspeito) exit(1);
+    uint32_t cabeca = 0, cauda = 0;
+    if (n > 0) ordem[cauda++] = 0;
+    while (cabeca < cauda) {
+        uint32_t sala = ordem[cabeca++];
+        if (mansao->esquerda[sala] >= 0 && cauda < n) ordem[cauda++] = (uint32_t) mansao->esquerda[sala];
+        if (mansao->direita[sala] >= 0 && cauda < n) ordem[cauda++] = (uint32_t) mansao->direita[sala];
+    }
+    for (uint32_t i = 0; i < cauda; i++) {
+        novoId[ordem[i]] = i;
+    }
+    for (uint32_t i = 0; i < cauda; i++) {
+        uint32_t antiga = ordem[i];
+        esquerda[i] = mansao->esquerda[antiga] >= 0 ? (int32_t) novoId[mansao->esquerda[antiga]] : -1;
+        direita[i] = mansao->direita[antiga] >= 0 ? (int32_t) novoId[mansao->direita[antiga]] : -1;
+        suspeito[i] = mansao->suspeito[antiga];
+    }
+    free(mansao->esquerda);
+    free(mansao->direita);
+    free(mansao->suspeito);
+    mansao->esquerda = esquerda;
+    mansao->direita = direita;
+    mansao->suspeito = suspeito;
+    mansao->nSalas = cauda;
+    free(novoId);
+    free(ordem);
+}
+
+/**
+ * @brief Exploração direta na árvore sucinta: 'e'/'d' descem com rank e 'v' volta
+ * à sala anterior com select. Nomes e pistas vêm do id da sala (mansão renumerada).
+ */
+void explorarArvoreSucinta(const ArvoreSucinta* arvore, const int32_t* suspeitoDaSala, PistaNode** bstPistas,
+                           HashNode* tabelaHash[], RankingSuspeitos* ranking, uint64_t* pistasColetadas) {
+    uint32_t salaAtual = 0;
+    char escolha[16], nome[32], pista[32];
+    while (salaAtual != SEM_SALA && arvore->nSalas > 0) {
+        nomeSalaGerada(salaAtual, nome, sizeof(nome));
+        printf("\n---------------------------------------\n");
+        printf("Voce esta em: %s\n", nome);
+        pista[0] = '\0';
+        if (suspeitoDaSala[salaAtual] >= 0) pistaSalaGerada(salaAtual, pista, sizeof(pista));
+        if (!coletarPista(salaAtual, pista, bstPistas, tabelaHash, ranking, pistasColetadas)) {
+            printf("Nenhuma pista nova neste comodo.\n");
+        }
+
+        uint32_t filhos[2] = { filhoSucinto(arvore, salaAtual, 0), filhoSucinto(arvore, salaAtual, 1) };
+        for (int lado = 0; lado < 2; lado++) {
+            if (filhos[lado] == SEM_SALA) continue;
+            nomeSalaGerada(filhos[lado], nome, sizeof(nome));
+            printf(" (%s) %s\n", lado == 0 ? "e" : "d", nome);
+        }
+        printf("Para onde voce quer ir? (e/d, v = voltar, s = sair, r = ranking): ");
+        if (scanf("%15s", escolha) != 1) break;
+
+        uint32_t proxima = SEM_SALA;
+        switch (escolha[0]) {
+            case 'e': case 'E': proxima = filhos[0]; break;
+            case 'd': case 'D': proxima = filhos[1]; break;
+            case 'v': case 'V': proxima = paiSucinto(arvore, salaAtual); break;
+            case 's': case 'S': salaAtual = SEM_SALA; continue;
+            case 'r': case 'R': exibirRanking(ranking); continue;
+            default: break;
+        }
+        if (proxima != SEM_SALA) {
+            salaAtual = proxima;
+        } else {
+            printf("Caminho bloqueado ou opcao invalida.\n");
+        }
+    }
+}
+
+/**
+ * @brief Modo de linha de comando: ./mestre --sucinta <arquivo>
+ * Joga uma mansão gerada usando apenas a árvore sucinta como mapa.
+ */
+int executarMansaoSucinta(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("Uso: %s --sucinta <arquivo>\n", argv[0]);
+        return 1;
+    }
+    MansaoGerada* mansao = carregarMansao(argv[2]);
+    if (!mansao) {
+        printf("Nao foi possivel carregar %s\n", argv[2]);
+        return 1;
+    }
+    renumerarMansaoEmLargura(mansao);
+    ArvoreSucinta* arvore = criarArvoreSucinta(mansao, NULL);
+    // As ligações por índice não são mais necessárias: o mapa é só a árvore sucinta
+    printf("Mapa sucinto: %u salas em %zu bytes (%.2f bits por sala; ligacoes por indice usariam %zu bytes)\n",
+           arvore->nSalas, bytesArvoreSucinta(arvore), 8.0 * (double) bytesArvoreSucinta(arvore) / arvore->nSalas,
+           2 * sizeof(int32_t) * (size_t) arvore->nSalas);
+    free(mansao->esquerda);
+    free(mansao->direita);
+    mansao->esquerda = mansao->direita = NULL;
+
+    BaseEvidencias* base = criarBaseGerada(mansao);
+    RankingSuspeitos* ranking = criarRanking(base, TOP_K_SUSPEITOS);
+    uint64_t* pistasColetadas = criarConjuntoBits(arvore->nSalas);
+    HashNode* tabelaHash[HASH_SIZE] = { NULL };
+    PistaNode* bstPistas = NULL;
+
+    explorarArvoreSucinta(arvore, mansao->suspeito, &bstPistas, tabelaHash, ranking, pistasColetadas);
+    verificarSuspeitoFinal(bstPistas, tabelaHash, ranking, NULL);
+
+    liberarPistas(bstPistas);
+    liberarHash(tabelaHash);
+    free(pistasColetadas);
+    liberarRanking(ranking);
+    liberarBaseEvidencias(base);
+    liberarArvoreSucinta(arvore);
+    liberarMansaoGerada(mansao);
+    return 0;
+}
+
+// --- Registro de Sessões e Análise Colunar ---
+
+/**
+ * @brief Abre (em modo de acréscimo) o registro de eventos de uma sessão e grava
+ * o evento de início com o número de salas do mapa e as assinaturas do mapa e da base.
+ * @return O registro, ou NULL se o arquivo não puder ser aberto.
+ */
+RegistroSessao* abrirRegistroSessao(const char* caminho, const MapaGrafo* mapa, const BaseEvidencias* base) {
+    FILE* arquivo = fopen(caminho, "ab");
+    if (!arquivo) return NULL;
+    RegistroSessao* registro = (RegistroSessao*) malloc(sizeof(RegistroSessao));
+    if (!registro) exit(1);
+    registro->arquivo = arquivo;
+    registro->caminhoSalas = (char*) malloc(strlen(caminho) + sizeof(".salas"));
+    if (!registro->caminhoSalas) exit(1);
+    sprintf(registro->caminhoSalas, "%s.salas", caminho);
+    registro->mapa = mapa;
+    registro->assinaturaMapa = assinaturaMapa(mapa);
+    struct timespec agora = { 0, 0 };
+    if (!timespec_get(&agora, TIME_UTC)) agora.tv_sec = time(NULL);
+    uint64_t semente = (uint64_t) agora.tv_sec * 1000000000ull + (uint64_t) agora.tv_nsec;
+    semente ^= ((uint64_t) clock() << 40) ^ (uint64_t) (uintptr_t) registro;
+    proximoAleatorio(&semente);
+    registro->sessao = proximoAleatorio(&semente);
+    registro->usados = 0;
+    registrarEvento(registro, EVENTO_INICIO, mapa->nSalas, 0);
+    registrarEvento(registro, EVENTO_MAPA, registro->assinaturaMapa, 0);
+    registrarBaseSessao(registro, base);
+    return registro;
+}
+
+/**
+ * @brief Registra a base de pistas em uso (no início ou depois de uma recarga) e,
+ * se o par (mapa, base) ainda não está em "<registro>.salas", grava suas salas com pista.
+ */
+void registrarBaseSessao(RegistroSessao* registro, const BaseEvidencias* base) {
+    if (!registro) return;
+    uint32_t assinatura = assinaturaBase(base);
+    registrarEvento(registro, EVENTO_BASE, assinatura, 0);
+    gravarSalasComPista(registro, assinatura, base);
+}
+
+/**
+ * @brief Acrescenta ao arquivo de salas com pista o conjunto do par (mapa do registro,
+ * `assinatura`), a não ser que ele já esteja lá. Só o primeiro registro de cada par
+ * percorre o mapa; os outros leem apenas os cabeçalhos (um por par).
+ */
+void gravarSalasComPista(const RegistroSessao* registro, uint32_t assinatura, const BaseEvidencias* base) {
+    const MapaGrafo* mapa = registro->mapa;
+    size_t palavras = ((size_t) mapa->nSalas + 63) / 64;
+    FILE* arquivo = fopen(registro->caminhoSalas, "rb");
+    uint32_t cabecalho[4];
+    while (arquivo && fread(cabecalho, sizeof(cabecalho), 1, arquivo) == 1) {
+        if (cabecalho[0] == registro->assinaturaMapa && cabecalho[1] == assinatura) {
+            fclose(arquivo);
+            return;
+        }
+        if (fseek(arquivo, (long) (((size_t) cabecalho[2] + 63) / 64 * sizeof(uint64_t)), SEEK_CUR) != 0) break;
+    }
+    if (arquivo) fclose(arquivo);
+
+    uint64_t* bits = criarConjuntoBits(mapa->nSalas);
+    char texto[TAM_TEXTO_MAPA];
+    for (uint32_t s = 0; s < mapa->nSalas; s++) {
+        const char* pista = textoDoMapa(mapa, mapa->pista[s], texto);
+        if (pista[0] && suspeitoPrincipal(base, pista)) marcarBit(bits, s);
+    }
+    arquivo = fopen(registro->caminhoSalas, "ab");
+    if (arquivo) {
+        uint32_t novo[4] = { registro->assinaturaMapa, assinatura, mapa->nSalas, 0 };
+        fwrite(novo, sizeof(novo), 1, arquivo);
+        fwrite(bits, sizeof(uint64_t), palavras, arquivo);
+        fclose(arquivo);
+    }
+    free(bits);
+}
+
+/**
+ * @brief Acrescenta um evento ao buffer do registro (não faz nada se `registro` for NULL).
+ */
+void registrarEvento(RegistroSessao* registro, uint8_t tipo, uint32_t valor, uint8_t acerto) {
+    if (!registro) return;
+    if (registro->usados == TAM_BUFFER_EVENTOS) {
+        fwrite(registro->buffer, sizeof(EventoSessao), registro->usados, registro->arquivo);
+        registro->usados = 0;
+    }
+    EventoSessao* evento = &registro->buffer[registro->usados++];
+    evento->sessao = registro->sessao;
+    evento->valor = valor;
+    evento->tipo = tipo;
+    evento->acerto = acerto;
+    evento->reservado = 0;
+}
+
+void fecharRegistroSessao(RegistroSessao* registro) {
+    if (!registro) return;
+    fwrite(registro->buffer, sizeof(EventoSessao), registro->usados, registro->arquivo);
+    fclose(registro->arquivo);
+    free(registro->caminhoSalas);
+    free(registro);
+}
+
+/**
+ * @brief Continua um hash FNV-1a (como hashTexto) sobre `tamanho` bytes.
+ */
+uint32_t hashBytes(uint32_t hash, const void* dados, size_t tamanho) {
+    const unsigned char* bytes = (const unsigned char*) dados;
+    for (size_t i = 0; i < tamanho; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Assinatura do mapa: saídas de cada sala, nomes e pistas (nunca 0).
+ */
+uint32_t assinaturaMapa(const MapaGrafo* mapa) {
+    uint32_t hash = hashBytes(2166136261u, &mapa->nSalas, sizeof(mapa->nSalas));
+    hash = hashBytes(hash, mapa->inicio, sizeof(uint32_t) * ((size_t) mapa->nSalas + 1));
+    hash = hashBytes(hash, mapa->destino, sizeof(uint32_t) * mapa->inicio[mapa->nSalas]);
+    char texto[TAM_TEXTO_MAPA];
+    for (uint32_t s = 0; s < mapa->nSalas; s++) {
+        const char* nome = textoDoMapa(mapa, mapa->nome[s], texto);
+        hash = hashBytes(hash, nome, strlen(nome) + 1);
+        const char* pista = textoDoMapa(mapa, mapa->pista[s], texto);
+        hash = hashBytes(hash, pista, strlen(pista) + 1);
+    }
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief Assinatura da base: suspeitos na ordem dos ids e as ligações de cada pista (nunca 0).
+ * Bases com a mesma assinatura dão os mesmos ids aos suspeitos.
+ */
+uint32_t assinaturaBase(const BaseEvidencias* base) {
+    uint32_t hash = 2166136261u;
+    for (int s = 0; s < base->suspeitos.quantidade; s++) {
+        hash = hashBytes(hash, base->suspeitos.textos[s], strlen(base->suspeitos.textos[s]) + 1);
+    }
+    for (int p = 0; p < base->pistas.quantidade; p++) {
+        hash = hashBytes(hash, base->pistas.textos[p], strlen(base->pistas.textos[p]) + 1);
+        int ligacoes = base->inicio[p + 1] - base->inicio[p];
+        hash = hashBytes(hash, base->suspeito + base->inicio[p], sizeof(int) * (size_t) ligacoes);
+        hash = hashBytes(hash, base->peso + base->inicio[p], sizeof(float) * (size_t) ligacoes);
+    }
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief Lê conjuntos de salas com pista (formato de "<registro>.salas") até o fim
+ * do arquivo e os acrescenta a `conjuntos`. Com `unicos`, pares (mapa, base) já
+ * presentes são pulados.
+ * @return 1 em caso de sucesso, 0 se o arquivo estiver truncado.
+ */
+int lerSalasComPista(FILE* arquivo, SalasComPista** conjuntos, uint32_t* nConjuntos, int unicos) {
+    uint32_t cabecalho[4];
+    while (fread(cabecalho, sizeof(cabecalho), 1, arquivo) == 1) {
+        size_t palavras = ((size_t) cabecalho[2] + 63) / 64;
+        uint64_t* bits = criarConjuntoBits(cabecalho[2]);
+        if (fread(bits, sizeof(uint64_t), palavras, arquivo) != palavras) {
+            free(bits);
+            return 0;
+        }
+        uint32_t c = 0;
+        while (unicos && c < *nConjuntos && ((*conjuntos)[c].mapa != cabecalho[0] || (*conjuntos)[c].base != cabecalho[1])) c++;
+        if (unicos && c < *nConjuntos) {
+            free(bits);
+            continue;
+        }
+        if ((*nConjuntos & (*nConjuntos - 1)) == 0) { // Capacidade dobra nas potências de 2
+            *conjuntos = (SalasComPista*) realloc(*conjuntos, sizeof(SalasComPista) * (*nConjuntos ? 2 * (size_t) *nConjuntos : 1));
+            if (!*conjuntos) exit(1);
+        }
+        (*conjuntos)[(*nConjuntos)++] = (SalasComPista) { cabecalho[0], cabecalho[1], cabecalho[2], bits };
+    }
+    return 1;
+}
+
+/**
+ * @brief Lê os registros de eventos (linhas) e os grava em formato colunar: cabeçalho
+ * "DQC2" + total de eventos, seguido das colunas tipo[] (uint8), valor[] (uint32),
+ * acerto[] (uint8) e sessao[] (uint64) e, até o fim do arquivo, das salas com pista
+ * de cada par (mapa, base) encontradas nos "<registro>.salas". As análises só leem
+ * as colunas de que precisam.
+ */
+int executarConversaoColunar(int argc, char* argv[]) {
+    if (argc < 4) {
+        printf("Uso: %s --colunar <saida.dqc> <registro> [registro ...]\n", argv[0]);
+        return 1;
+    }
+    size_t total = 0, capacidade = 1 << 20;
+    EventoSessao* eventos = (EventoSessao*) malloc(sizeof(EventoSessao) * capacidade);
+    if (!eventos) exit(1);
+    SalasComPista* conjuntos = NULL;
+    uint32_t nConjuntos = 0;
+    for (int a = 3; a < argc; a++) {
+        FILE* arquivo = fopen(argv[a], "rb");
+        if (!arquivo) {
+            printf("Nao foi possivel abrir %s\n", argv[a]);
+            free(eventos);
+            return 1;
+        }
+        size_t lidos;
+        do {
+            if (total == capacidade) {
+                capacidade *= 2;
+                eventos = (EventoSessao*) realloc(eventos, sizeof(EventoSessao) * capacidade);
+                if (!eventos) exit(1);
+            }
+            lidos = fread(eventos + total, sizeof(EventoSessao), capacidade - total, arquivo);
+            total += lidos;
+        } while (lidos > 0);
+        fclose(arquivo);
+
+        // Salas com pista dos pares (mapa, base) do registro (registros sem elas ficam sem referência)
+        char* caminhoSalas = (char*) malloc(strlen(argv[a]) + sizeof(".salas"));
+        if (!caminhoSalas) exit(1);
+        sprintf(caminhoSalas, "%s.salas", argv[a]);
+        arquivo = fopen(caminhoSalas, "rb");
+        if (arquivo && !lerSalasComPista(arquivo, &conjuntos, &nConjuntos, 1)) {
+            printf("Aviso: %s truncado; os conjuntos completos foram mantidos.\n", caminhoSalas);
+        }
+        if (arquivo) fclose(arquivo);
+        free(caminhoSalas);
+    }
+
+    double relogio = relogioParede();
+    int64_t n = (int64_t) total;
+    uint8_t* tipo = (uint8_t*) malloc(total + 1);
+    uint32_t* valor = (uint32_t*) malloc(sizeof(uint32_t) * (total + 1));
+    uint8_t* acerto = (uint8_t*) malloc(total + 1);
+    uint64_t* sessao = (uint64_t*) malloc(sizeof(uint64_t) * (total + 1));
+    if (!tipo || !valor || !acerto || !sessao) exit(1);
+    PARALELO_PARA
+    for (int64_t i = 0; i < n; i++) {
+        tipo[i] = eventos[i].tipo;
+        valor[i] = eventos[i].valor;
+        acerto[i] = eventos[i].acerto;
+        sessao[i] = eventos[i].sessao;
+    }
+    free(eventos);
+
+    FILE* saida = fopen(argv[2], "wb");
+    uint64_t total64 = total;
+    int ok = saida && fwrite(MAGICA_COLUNAR, 1, 4, saida) == 4 && fwrite(&total64, sizeof(total64), 1, saida) == 1
+          && fwrite(tipo, 1, total, saida) == total && fwrite(valor, sizeof(uint32_t), total, saida) == total
+          && fwrite(acerto, 1, total, saida) == total && fwrite(sessao, sizeof(uint64_t), total, saida) == total;
+    for (uint32_t c = 0; c < nConjuntos; c++) {
+        uint32_t cabecalho[4] = { conjuntos[c].mapa, conjuntos[c].base, conjuntos[c].nSalas, 0 };
+        size_t palavras = ((size_t) conjuntos[c].nSalas + 63) / 64;
+        ok = ok && fwrite(cabecalho, sizeof(cabecalho), 1, saida) == 1
+                && fwrite(conjuntos[c].bits, sizeof(uint64_t), palavras, saida) == palavras;
+        free(conjuntos[c].bits);
+    }
+    free(conjuntos);
+    if (saida && fclose(saida) != 0) ok = 0;
+    free(tipo);
+    free(valor);
+    free(acerto);
+    free(sessao);
+    if (!ok) {
+        printf("Erro ao gravar %s\n", argv[2]);
+        return 1;
+    }
+    printf("%zu eventos e %u conjunto(s) de salas com pista convertidos para %s em %.3fs\n", total, nConjuntos, argv[2],
+           relogioParede() - relogio);
+    return 0;
+}
+
+/**
+ * @brief Conta, em paralelo, os eventos de um tipo por valor (histograma).
+ * Cada thread acumula em seu próprio vetor e os parciais são somados no fim.
+ * Com `grupo`, só entram os eventos cujo grupo está marcado em `incluir`.
+ */
+uint64_t* histogramaPorValor(const uint8_t* tipo, const uint32_t* valor, const uint8_t* acerto, const uint32_t* grupo,
+                             const uint8_t* incluir, int64_t n, uint8_t tipoProcurado, uint32_t nValores) {
+    // Duas colunas por valor: total de eventos e eventos com acerto
+    uint64_t* contagem = (uint64_t*) calloc(2 * (size_t) nValores + 2, sizeof(uint64_t));
+    if (!contagem) exit(1);
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+        uint64_t* parcial = (uint64_t*) calloc(2 * (size_t) nValores + 2, sizeof(uint64_t));
+        if (!parcial) exit(1);
+#ifdef _OPENMP
+        #pragma omp for schedule(static) nowait
+#endif
+        for (int64_t i = 0; i < n; i++) {
+            if (tipo[i] == tipoProcurado && valor[i] < nValores && (!grupo || incluir[grupo[i]])) {
+                parcial[2 * (size_t) valor[i]]++;
+                parcial[2 * (size_t) valor[i] + 1] += acerto[i];
+            }
+        }
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        for (size_t v = 0; v < 2 * (size_t) nValores; v++) {
+            contagem[v] += parcial[v];
+        }
+        free(parcial);
+    }
+    return contagem;
+}
+
+/**
+ * @brief Imprime os `limite` valores com maior (ou menor) contagem de um histograma.
+ */
+void exibirDestaques(const char* titulo, const char* rotulo, const uint64_t* contagem, uint32_t nValores,
+                     const uint64_t* referencia, int limite, int menores) {
+    printf("\n%s\n", titulo);
+    char* usado = (char*) calloc((size_t) nValores + 1, 1);
+    if (!usado) exit(1);
+    for (int k = 0; k < limite; k++) {
+        int64_t melhor = -1;
+        double melhorTaxa = 0;
+        for (uint32_t v = 0; v < nValores; v++) {
+            if (usado[v] || (referencia ? referencia[v] == 0 : contagem[2 * (size_t) v] == 0)) continue;
+            double taxa = referencia ? (double) contagem[2 * (size_t) v] / (double) referencia[v] : (double) contagem[2 * (size_t) v];
+            if (melhor < 0 || (menores ? taxa < melhorTaxa : taxa > melhorTaxa)) {
+                melhor = v;
+                melhorTaxa = taxa;
+            }
+        }
+        if (melhor < 0) break;
+        usado[melhor] = 1;
+        if (referencia) {
+            printf("- %s %lld: %.1f%% (%llu de %llu)\n", rotulo, (long long) melhor, 100.0 * melhorTaxa,
+                   (unsigned long long) contagem[2 * (size_t) melhor], (unsigned long long) referencia[melhor]);
+        } else {
+            printf("- %s %lld: %llu\n", rotulo, (long long) melhor, (unsigned long long) contagem[2 * (size_t) melhor]);
+        }
+    }
+    free(usado);
+}
+
+// Estado de uma sessão durante o agrupamento (tabela com endereçamento aberto)
+typedef struct {
+    uint64_t sessao;
+    uint32_t mapa;
+    uint32_t base;
+    uint32_t grupo;
+    uint8_t usado;
+} EstadoSessaoAnalise;
+
+/**
+ * @brief Atribui cada evento a um grupo (mapa, base), seguindo as assinaturas
+ * registradas por sessão. O grupo 0 reúne eventos sem assinatura (registros antigos).
+ * Percorre os eventos em ordem, pois a base pode mudar no meio de uma sessão.
+ * @return Quantos grupos foram encontrados; `grupos` recebe mapa, base e sessões de cada um.
+ */
+uint32_t agruparPorAssinatura(const uint8_t* tipo, const uint32_t* valor, const uint64_t* sessao, int64_t n,
+                              uint64_t sessoes, uint32_t* grupo, GrupoAnalise** grupos) {
+    size_t capacidade = 16;
+    while (capacidade / 2 < sessoes + 1) {
+        if (capacidade > SIZE_MAX / 2 / sizeof(EstadoSessaoAnalise)) exit(1); // Não caberia na memória
+        capacidade *= 2;
+    }
+    EstadoSessaoAnalise* estados = (EstadoSessaoAnalise*) calloc(capacidade, sizeof(EstadoSessaoAnalise));
+    uint32_t nGrupos = 1, capGrupos = 16;
+    GrupoAnalise* lista = (GrupoAnalise*) calloc(capGrupos, sizeof(GrupoAnalise));
+    if (!estados || !lista) exit(1);
+
+    EstadoSessaoAnalise* estado = NULL; // Eventos de uma sessão costumam vir juntos
+    for (int64_t i = 0; i < n; i++) {
+        if (!estado || estado->sessao != sessao[i]) {
+            uint64_t espalhado = sessao[i] * 0x9E3779B97F4A7C15ull;
+            size_t s = (size_t) (espalhado ^ (espalhado >> 32));
+            for (s &= capacidade - 1; estados[s].usado && estados[s].sessao != sessao[i];
+                 s = (s + 1) & (capacidade - 1)) {}
+            estado = &estados[s];
+            if (!estado->usado && tipo[i] != EVENTO_INICIO) {
+                estado = NULL; // Sessão sem início (registro cortado): fica sem assinatura
+                grupo[i] = 0;
+                lista[0].acusacoes += tipo[i] == EVENTO_ACUSACAO;
+                continue;
+            }
+        }
+        if (tipo[i] == EVENTO_INICIO) {
+            *estado = (EstadoSessaoAnalise) { sessao[i], 0, 0, 0, 1 }; // Nova sessão (ou id repetido)
+        }
+        if (tipo[i] == EVENTO_MAPA || tipo[i] == EVENTO_BASE) {
+            if (tipo[i] == EVENTO_MAPA) estado->mapa = valor[i];
+            else estado->base = valor[i];
+            uint32_t g = 0;
+            while (g < nGrupos && (lista[g].mapa != estado->mapa || lista[g].base != estado->base)) g++;
+            if (g == nGrupos) {
+                if (nGrupos == capGrupos) {
+                    capGrupos *= 2;
+                    lista = (GrupoAnalise*) realloc(lista, sizeof(GrupoAnalise) * capGrupos);
+                    if (!lista) exit(1);
+                }
+                lista[nGrupos] = (GrupoAnalise) { estado->mapa, estado->base, 0, 0, 0 };
+                nGrupos++;
+            }
+            estado->grupo = g;
+            if (tipo[i] == EVENTO_MAPA) lista[g].sessoes++;
+            else if (estado->mapa) lista[g].entradas++;
+        }
+        grupo[i] = estado->grupo;
+        lista[estado->grupo].acusacoes += tipo[i] == EVENTO_ACUSACAO;
+    }
+    free(estados);
+    *grupos = lista;
+    return nGrupos;
+}
+
+/**
+ * @brief Quantas sessões dos grupos marcados em `incluir` tinham pista em cada sala:
+ * as entradas de cada grupo somadas nas salas do seu conjunto (mapa, base).
+ * @return As contagens, ou NULL se nenhum grupo marcado tem conjunto.
+ */
+uint64_t* contarSalasComPista(const GrupoAnalise* grupos, uint32_t nGrupos, const uint8_t* incluir,
+                              const SalasComPista* conjuntos, uint32_t nConjuntos, uint32_t nValores) {
+    uint64_t* comPista = NULL;
+    for (uint32_t g = 0; g < nGrupos; g++) {
+        if (!incluir[g] || grupos[g].entradas == 0) continue;
+        uint32_t c = 0;
+        while (c < nConjuntos && (conjuntos[c].mapa != grupos[g].mapa || conjuntos[c].base != grupos[g].base)) c++;
+        if (c == nConjuntos) continue;
+        if (!comPista) comPista = (uint64_t*) calloc((size_t) nValores + 1, sizeof(uint64_t));
+        if (!comPista) exit(1);
+        uint32_t limite = conjuntos[c].nSalas < nValores ? conjuntos[c].nSalas : nValores;
+        for (uint32_t s = 0; s < limite; s++) {
+            if (testarBit(conjuntos[c].bits, s)) comPista[s] += grupos[g].entradas;
+        }
+    }
+    return comPista;
+}
+
+/**
+ * @brief Mapa de calor de visitas e pistas mais perdidas dos grupos marcados em `incluir`.
+ * `comPista` (pode ser NULL) traz, por sala, as sessões em que ela tinha pista.
+ */
+void exibirAnaliseSalas(const uint8_t* tipo, const uint32_t* valor, const uint8_t* acerto, const uint32_t* grupo,
+                        const uint8_t* incluir, int64_t n, uint32_t nValores, uint64_t sessoes, const uint64_t* comPista) {
+    uint64_t* visitas = histogramaPorValor(tipo, valor, acerto, grupo, incluir, n, EVENTO_VISITA, nValores);
+    uint64_t* coletas = histogramaPorValor(tipo, valor, acerto, grupo, incluir, n, EVENTO_PISTA, nValores);
+
+    // Referência para a taxa de coleta: sessões em que a sala tinha pista.
+    // Registros sem salas com pista usam as salas já coletadas.
+    uint64_t* porSessao = (uint64_t*) malloc(sizeof(uint64_t) * nValores);
+    if (!porSessao) exit(1);
+    for (uint32_t v = 0; v < nValores; v++) {
+        porSessao[v] = comPista ? comPista[v] : (coletas[2 * (size_t) v] ? sessoes : 0);
+    }
+    exibirDestaques("Salas mais visitadas:", "Sala", visitas, nValores, NULL, 10, 0);
+    exibirDestaques("Pistas mais perdidas (taxa de coleta por sessao):", "Pista da sala", coletas, nValores, porSessao, 10, 1);
+    free(porSessao);
+    free(visitas);
+    free(coletas);
+}
+
+/**
+ * @brief Acusações e precisão por suspeito dos grupos marcados em `incluir`.
+ */
+void exibirAnaliseSuspeitos(const uint8_t* tipo, const uint32_t* valor, const uint8_t* acerto, const uint32_t* grupo,
+                            const uint8_t* incluir, int64_t n, uint32_t nValores) {
+    uint64_t* acusacoes = histogramaPorValor(tipo, valor, acerto, grupo, incluir, n, EVENTO_ACUSACAO, nValores);
+    uint64_t* porAcusacao = (uint64_t*) malloc(sizeof(uint64_t) * nValores);
+    uint64_t* acertos = (uint64_t*) malloc(sizeof(uint64_t) * 2 * (size_t) nValores);
+    if (!porAcusacao || !acertos) exit(1);
+    for (uint32_t v = 0; v < nValores; v++) {
+        porAcusacao[v] = acusacoes[2 * (size_t) v];
+        acertos[2 * (size_t) v] = acusacoes[2 * (size_t) v + 1];
+    }
+    exibirDestaques("Suspeitos mais acusados:", "Suspeito", acusacoes, nValores, NULL, 10, 0);
+    exibirDestaques("Precisao das acusacoes por suspeito:", "Suspeito", acertos, nValores, porAcusacao, 10, 0);
+    free(acertos);
+    free(porAcusacao);
+    free(acusacoes);
+}
+
+/**
+ * @brief Modo de linha de comando: ./mestre --analisar <arquivo.dqc>
+ * Calcula o mapa de calor de visitas por sala, a taxa de coleta de cada pista
+ * (pistas mais perdidas, inclusive as nunca coletadas) e a precisão das acusações por suspeito.
+ * Salas só são comparadas dentro do mesmo mapa e suspeitos dentro da mesma base.
+ */
+int executarAnalise(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("Uso: %s --analisar <arquivo.dqc>\n", argv[0]);
+        return 1;
+    }
+    FILE* arquivo = fopen(argv[2], "rb");
+    char magica[4];
+    uint64_t total = 0;
+    if (!arquivo || fread(magica, 1, 4, arquivo) != 4 || memcmp(magica, MAGICA_COLUNAR, 4) != 0
+        || fread(&total, sizeof(total), 1, arquivo) != 1) {
+        printf("Arquivo colunar invalido: %s\n", argv[2]);
+        if (arquivo) fclose(arquivo);
+        return 1;
+    }
+    uint8_t* tipo = (uint8_t*) malloc(total + 1);
+    uint32_t* valor = (uint32_t*) malloc(sizeof(uint32_t) * (total + 1));
+    uint8_t* acerto = (uint8_t*) malloc(total + 1);
+    uint64_t* sessao = (uint64_t*) malloc(sizeof(uint64_t) * (total + 1));
+    uint32_t* grupo = (uint32_t*) malloc(sizeof(uint32_t) * (total + 1));
+    if (!tipo || !valor || !acerto || !sessao || !grupo) exit(1);
+    int ok = fread(tipo, 1, total, arquivo) == total && fread(valor, sizeof(uint32_t), total, arquivo) == total
+          && fread(acerto, 1, total, arquivo) == total && fread(sessao, sizeof(uint64_t), total, arquivo) == total;
+    SalasComPista* conjuntos = NULL;
+    uint32_t nConjuntos = 0;
+    ok = ok && lerSalasComPista(arquivo, &conjuntos, &nConjuntos, 1);
+    fclose(arquivo);
+    if (!ok) {
+        for (uint32_t c = 0; c < nConjuntos; c++) free(conjuntos[c].bits);
+        free(conjuntos);
+        printf("Arquivo colunar truncado: %s\n", argv[2]);
+        free(tipo);
+        free(valor);
+        free(acerto);
+        free(sessao);
+        free(grupo);
+        return 1;
+    }
+
+    double relogio = relogioParede();
+    int64_t n = (int64_t) total;
+    uint64_t sessoes = 0;
+    uint32_t maiorValor = 0;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+:sessoes) reduction(max:maiorValor)
+#endif
+    for (int64_t i = 0; i < n; i++) {
+        sessoes += tipo[i] == EVENTO_INICIO;
+        if (tipo[i] == EVENTO_INICIO || tipo[i] == EVENTO_MAPA || tipo[i] == EVENTO_BASE) continue;
+        if (valor[i] != SEM_SALA && valor[i] > maiorValor) maiorValor = valor[i];
+    }
+    // Salas com pista nunca visitadas também entram (taxa de coleta 0%)
+    for (uint32_t c = 0; c < nConjuntos; c++) {
+        if (conjuntos[c].nSalas > 0 && conjuntos[c].nSalas - 1 > maiorValor) maiorValor = conjuntos[c].nSalas - 1;
+    }
+    uint32_t nValores = maiorValor + 1;
+    GrupoAnalise* grupos = NULL;
+    uint32_t nGrupos = agruparPorAssinatura(tipo, valor, sessao, n, sessoes, grupo, &grupos);
+    double agrupamento = relogioParede() - relogio;
+
+    // Mapas e bases distintos; cada um marca em `incluir` os grupos (mapa, base) que o contêm
+    uint32_t* mapas = (uint32_t*) malloc(sizeof(uint32_t) * nGrupos);
+    uint32_t* bases = (uint32_t*) malloc(sizeof(uint32_t) * nGrupos);
+    uint8_t* incluir = (uint8_t*) malloc(nGrupos);
+    if (!mapas || !bases || !incluir) exit(1);
+    uint32_t nMapas = 0, nBases = 0;
+    for (uint32_t g = 0; g < nGrupos; g++) {
+        uint32_t m = 0, b = 0;
+        while (m < nMapas && mapas[m] != grupos[g].mapa) m++;
+        if (m == nMapas) mapas[nMapas++] = grupos[g].mapa;
+        while (b < nBases && bases[b] != grupos[g].base) b++;
+        if (b == nBases) bases[nBases++] = grupos[g].base;
+    }
+
+    // Registros antigos: as sessões sem assinatura de mapa são as que sobram
+    uint64_t semAssinatura = sessoes;
+    for (uint32_t g = 0; g < nGrupos; g++) semAssinatura -= grupos[g].sessoes;
+    // O grupo 0 (sem assinatura) sempre existe: não conta como mapa nem como base
+    printf("%llu eventos, %llu sessoes, %u mapa(s) e %u base(s) identificados; agrupamento em %.3fs\n",
+           (unsigned long long) total, (unsigned long long) sessoes, nMapas - 1, nBases - 1, agrupamento);
+    relogio = relogioParede();
+    int passadas = 0; // Cada histograma percorre as colunas uma vez
+    for (uint32_t m = 0; m < nMapas; m++) {
+        uint64_t sessoesMapa = 0;
+        for (uint32_t g = 0; g < nGrupos; g++) {
+            incluir[g] = grupos[g].mapa == mapas[m];
+            if (incluir[g]) sessoesMapa += grupos[g].sessoes;
+        }
+        if (mapas[m] == 0) {
+            sessoesMapa = semAssinatura;
+            if (sessoesMapa == 0 && nMapas > 1) continue;
+            printf("\n=== Mapa sem assinatura (%llu sessoes) ===\n", (unsigned long long) sessoesMapa);
+        } else {
+            printf("\n=== Mapa %08x (%llu sessoes) ===\n", mapas[m], (unsigned long long) sessoesMapa);
+        }
+        uint64_t* comPista = contarSalasComPista(grupos, nGrupos, incluir, conjuntos, nConjuntos, nValores);
+        exibirAnaliseSalas(tipo, valor, acerto, grupo, incluir, n, nValores, sessoesMapa, comPista);
+        free(comPista);
+        passadas += 2;
+    }
+    for (uint32_t b = 0; b < nBases; b++) {
+        uint64_t acusacoesBase = 0;
+        for (uint32_t g = 0; g < nGrupos; g++) {
+            incluir[g] = grupos[g].base == bases[b];
+            if (incluir[g]) acusacoesBase += grupos[g].acusacoes;
+        }
+        if (acusacoesBase == 0) continue;
+        if (bases[b] == 0) {
+            printf("\n=== Base sem assinatura ===\n");
+        } else {
+            printf("\n=== Base de pistas %08x ===\n", bases[b]);
+        }
+        exibirAnaliseSuspeitos(tipo, valor, acerto, grupo, incluir, n, nValores);
+        passadas++;
+    }
+    double segundos = relogioParede() - relogio;
+    printf("\n%d agregacoes em %.3fs (%.0fM eventos/s por agregacao)\n", passadas, segundos,
+           segundos > 0 ? (double) total * passadas / segundos / 1e6 : 0.0);
+
+    for (uint32_t c = 0; c < nConjuntos; c++) free(conjuntos[c].bits);
+    free(conjuntos);
+    free(incluir);
+    free(bases);
+    free(mapas);
+    free(grupos);
+    free(tipo);
+    free(valor);
+    free(acerto);
+    free(sessao);
+    free(grupo);
+    return 0;
+}
+
+// --- Recarga da Base de Pistas (publicação RCU por épocas) ---
+
+/**
+ * @brief Cria a publicação com a versão 1 da base (a publicação passa a ser dona dela).
+ */
+PublicacaoBase* criarPublicacaoBase(BaseEvidencias* inicial) {
+    PublicacaoBase* publicacao = (PublicacaoBase*) calloc(1, sizeof(PublicacaoBase));
+    VersaoBase* versao = (VersaoBase*) calloc(1, sizeof(VersaoBase));
+    if (!publicacao || !versao) exit(1);
+    versao->base = inicial;
+    versao->numero = 1;
+    atomic_init(&publicacao->atual, versao);
+    atomic_init(&publicacao->epoca, 1);
+    for (int i = 0; i < MAX_LEITORES_BASE; i++) {
+        atomic_init(&publicacao->leitores[i], 0);
+        atomic_init(&publicacao->ocupado[i], 0);
+    }
+    atomic_init(&publicacao->parar, 0);
+    publicacao->versoes = 1;
+    return publicacao;
+}
+
+/**
+ * @brief Reserva uma posição de leitor (uma por sessão ou thread).
+ * @return O índice do leitor, ou -1 se todas estiverem ocupadas.
+ */
+int registrarLeitorBase(PublicacaoBase* publicacao) {
+    for (int i = 0; i < MAX_LEITORES_BASE; i++) {
+        int livre = 0;
+        if (atomic_compare_exchange_strong(&publicacao->ocupado[i], &livre, 1)) {
+            atomic_store(&publicacao->leitores[i], 0);
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Ponto de quiescência do leitor: anuncia a época atual e devolve a base
+ * publicada. Nunca bloqueia. A versão devolvida continua válida até a próxima
+ * chamada (ou sairLeituraBase); a versão obtida antes desta chamada não pode mais ser usada.
+ */
+const BaseEvidencias* lerBaseAtual(PublicacaoBase* publicacao, int leitor, uint32_t* numero) {
+    atomic_store(&publicacao->leitores[leitor], atomic_load(&publicacao->epoca));
+    VersaoBase* versao = atomic_load(&publicacao->atual);
+    if (numero) *numero = versao->numero;
+    return versao->base;
+}
+
+/**
+ * @brief O leitor deixa de segurar qualquer versão (não atrasa mais a liberação).
+ */
+void sairLeituraBase(PublicacaoBase* publicacao, int leitor) {
+    atomic_store(&publicacao->leitores[leitor], 0);
+}
+
+void liberarLeitorBase(PublicacaoBase* publicacao, int leitor) {
+    if (!publicacao || leitor < 0) return;
+    sairLeituraBase(publicacao, leitor);
+    atomic_store(&publicacao->ocupado[leitor], 0);
+}
+
+/**
+ * @brief Libera as versões aposentadas que nenhum leitor ativo pode estar usando:
+ * uma versão aposentada na época E só é vista por leitores que anunciaram época < E.
+ * Só o publicador chama esta função.
+ * @return Quantas versões foram liberadas.
+ */
+int recolherVersoesBase(PublicacaoBase* publicacao) {
+    uint64_t menorEpoca = UINT64_MAX;
+    for (int i = 0; i < MAX_LEITORES_BASE; i++) {
+        if (!atomic_load(&publicacao->ocupado[i])) continue;
+        uint64_t epoca = atomic_load(&publicacao->leitores[i]);
+        if (epoca != 0 && epoca < menorEpoca) menorEpoca = epoca;
+    }
+    int liberadas = 0;
+    VersaoBase** ligacao = &publicacao->aposentadas;
+    while (*ligacao) {
+        VersaoBase* versao = *ligacao;
+        if (versao->aposentadaEm <= menorEpoca) {
+            *ligacao = versao->proxima;
+            liberarBaseEvidencias(versao->base);
+            free(versao);
+            liberadas++;
+        } else {
+            ligacao = &versao->proxima;
+        }
+    }
+    publicacao->recolhidas += (uint32_t) liberadas;
+    return liberadas;
+}
+
+/**
+ * @brief Publica uma nova base de uma só vez (troca atômica do ponteiro) e aposenta
+ * a anterior. Leitores em andamento continuam com a versão que já tinham.
+ * Há um único publicador (a thread de recarga ou, sem threads, a própria sessão).
+ */
+void publicarBase(PublicacaoBase* publicacao, BaseEvidencias* nova) {
+    VersaoBase* versao = (VersaoBase*) calloc(1, sizeof(VersaoBase));
+    if (!versao) exit(1);
+    versao->base = nova;
+    versao->numero = ++publicacao->versoes;
+    VersaoBase* anterior = atomic_exchange(&publicacao->atual, versao);
+    anterior->aposentadaEm = atomic_fetch_add(&publicacao->epoca, 1) + 1;
+    anterior->proxima = publicacao->aposentadas;
+    publicacao->aposentadas = anterior;
+    recolherVersoesBase(publicacao);
+}
+
+/**
+ * @brief Monta uma base a partir de um texto com uma associação por linha:
+ * "pista;suspeito[;peso]" (linhas vazias e iniciadas por '#' são ignoradas).
+ * O texto é dividido no próprio buffer. O peso, se presente, precisa ser um número
+ * finito sem nada depois dele.
+ * @return A base, ou NULL se alguma linha for inválida ou não houver associações.
+ */
+BaseEvidencias* lerBaseDeTexto(char* conteudo) {
+    int capacidade = 64, n = 0;
+    AssociacaoPista* associacoes = (AssociacaoPista*) malloc(sizeof(AssociacaoPista) * (size_t) capacidade);
+    if (!associacoes) exit(1);
+    char* linha = conteudo;
+    int valida = 1;
+    while (linha && *linha && valida) {
+        char* fimLinha = strchr(linha, '\n');
+        if (fimLinha) *fimLinha++ = '\0';
+        size_t tamanho = strlen(linha);
+        if (tamanho > 0 && linha[tamanho - 1] == '\r') linha[--tamanho] = '\0';
+        if (tamanho > 0 && linha[0] != '#') {
+            char* suspeito = strchr(linha, ';');
+            char* peso = suspeito ? strchr(suspeito + 1, ';') : NULL;
+            if (suspeito) *suspeito++ = '\0';
+            if (peso) *peso++ = '\0';
+            // Os textos precisam caber nos nós da BST (100) e da Tabela Hash (50);
+            // o suspeito não pode ter espaços porque a acusação é lida com scanf("%49s")
+            valida = suspeito && linha[0] && suspeito[0] && strlen(linha) < 100 && strlen(suspeito) < 50
+                     && !strchr(suspeito, ' ');
+            float valorPeso = 1.0f;
+            if (valida && peso) {
+                char* fimPeso = NULL;
+                valorPeso = strtof(peso, &fimPeso);
+                while (fimPeso && (*fimPeso == ' ' || *fimPeso == '\t')) fimPeso++;
+                // valorPeso - valorPeso só é 0 para valores finitos (NaN e infinitos dão NaN)
+                valida = fimPeso != peso && *fimPeso == '\0' && valorPeso - valorPeso == 0.0f;
+            }
+            if (valida) {
+                if (n == capacidade) {
+                    capacidade *= 2;
+                    associacoes = (AssociacaoPista*) realloc(associacoes, sizeof(AssociacaoPista) * (size_t) capacidade);
+                    if (!associacoes) exit(1);
+                }
+                associacoes[n].pista = linha;
+                associacoes[n].suspeito = suspeito;
+                associacoes[n++].peso = valorPeso;
+            }
+        }
+        linha = fimLinha;
+    }
+    BaseEvidencias* base = valida && n > 0 ? criarBaseEvidencias(associacoes, n) : NULL;
+    free(associacoes);
+    return base;
+}
+
+/**
+ * @brief Relê o arquivo da base e, se o conteúdo mudou e é válido, publica a nova versão.
+ * @return 1 se uma nova versão foi publicada.
+ */
+int recarregarBaseDoArquivo(PublicacaoBase* publicacao) {
+    recolherVersoesBase(publicacao);
+    FILE* arquivo = publicacao->arquivo ? fopen(publicacao->arquivo, "rb") : NULL;
+    if (!arquivo) return 0;
+    size_t tamanho = 0, capacidade = 4096, lidos;
+    char* conteudo = (char*) malloc(capacidade);
+    if (!conteudo) exit(1);
+    while ((lidos = fread(conteudo + tamanho, 1, capacidade - tamanho - 1, arquivo)) > 0) {
+        tamanho += lidos;
+        if (tamanho + 1 == capacidade) {
+            capacidade *= 2;
+            conteudo = (char*) realloc(conteudo, capacidade);
+            if (!conteudo) exit(1);
+        }
+    }
+    fclose(arquivo);
+    conteudo[tamanho] = '\0';
+
+    uint32_t assinatura = hashTexto(conteudo);
+    int publicada = 0;
+    if (assinatura != publicacao->assinatura) {
+        publicacao->assinatura = assinatura;
+        BaseEvidencias* base = lerBaseDeTexto(conteudo);
+        if (base) {
+            publicarBase(publicacao, base);
+            publicada = 1;
+        } else {
+            fprintf(stderr, "[recarga] %s invalido; a base atual foi mantida.\n", publicacao->arquivo);
+        }
+    }
+    free(conteudo);
+    return publicada;
+}
+
+#ifndef __STDC_NO_THREADS__
+/**
+ * @brief Thread de recarga: confere o arquivo a cada INTERVALO_RECARGA_MS.
+ */
+int executarRecargaBase(void* argumento) {
+    PublicacaoBase* publicacao = (PublicacaoBase*) argumento;
+    struct timespec intervalo = { INTERVALO_RECARGA_MS / 1000, (INTERVALO_RECARGA_MS % 1000) * 1000000L };
+    while (!atomic_load(&publicacao->parar)) {
+        recarregarBaseDoArquivo(publicacao);
+        thrd_sleep(&intervalo, NULL);
+    }
+    return 0;
+}
+#endif
+
+/**
+ * @brief Passa a acompanhar `caminho`: a versão atual é carregada agora e as
+ * mudanças seguintes são publicadas em segundo plano (ou, sem suporte a threads
+ * C11, nos pontos de quiescência da sessão).
+ * @return 1 se o arquivo pôde ser lido como base.
+ */
+int iniciarRecargaBase(PublicacaoBase* publicacao, const char* caminho) {
+    publicacao->arquivo = caminho;
+    int carregada = recarregarBaseDoArquivo(publicacao);
+#ifndef __STDC_NO_THREADS__
+    publicacao->recargaAtiva = thrd_create(&publicacao->recarga, executarRecargaBase, publicacao) == thrd_success;
+#endif
+    return carregada;
+}
+
+void pararRecargaBase(PublicacaoBase* publicacao) {
+#ifndef __STDC_NO_THREADS__
+    if (publicacao->recargaAtiva) {
+        atomic_store(&publicacao->parar, 1);
+        thrd_join(publicacao->recarga, NULL);
+        publicacao->recargaAtiva = 0;
+    }
+#else
+    (void) publicacao;
+#endif
+}
+
+/**
+ * @brief Liga o ranking (criado com a base atual da publicação) à publicação: ele
+ * passa a ocupar uma posição de leitor e a guardar as pistas registradas, para
+ * refazer as pontuações quando a base mudar.
+ * @return 1 se havia posição de leitor livre.
+ */
+int conectarRankingPublicacao(RankingSuspeitos* ranking, PublicacaoBase* publicacao) {
+    int leitor = registrarLeitorBase(publicacao);
+    if (leitor < 0) return 0;
+    ranking->publicacao = publicacao;
+    ranking->leitor = leitor;
+    lerBaseAtual(publicacao, leitor, &ranking->versaoBase);
+    return 1;
+}
+
+/**
+ * @brief Ponto seguro da sessão: adota a versão publicada mais recente da base.
+ * Se ela mudou, refaz o ranking com as pistas já registradas e atualiza o suspeito
+ * de cada uma na Tabela Hash (vazio se a pista saiu da base), mantendo
+ * contarPistasParaSuspeito coerente com o ranking.
+ * @return 1 se a sessão passou para uma nova versão.
+ */
+int sincronizarBase(RankingSuspeitos* ranking, HashNode* tabelaHash[]) {
+    if (!ranking->publicacao) return 0;
+#ifdef __STDC_NO_THREADS__
+    recarregarBaseDoArquivo(ranking->publicacao); // Sem thread de recarga, a sessão confere o arquivo
+#endif
+    uint32_t numero;
+    const BaseEvidencias* base = lerBaseAtual(ranking->publicacao, ranking->leitor, &numero);
+    if (numero == ranking->versaoBase) return 0;
+    ranking->versaoBase = numero;
+
+    free(ranking->pontuacao);
+    free(ranking->posHeap);
+    free(ranking->heap);
+    prepararRanking(ranking, base);
+    for (int i = 0; i < ranking->nRegistradas; i++) {
+        somarEvidencia(ranking, ranking->registradas[i]);
+        const char* suspeito = suspeitoPrincipal(base, ranking->registradas[i]);
+        atualizarSuspeitoNaHash(tabelaHash, ranking->registradas[i], suspeito ? suspeito : "");
+    }
+    return 1;
+}
+
+#ifndef __STDC_NO_THREADS__
+// Leitor do benchmark de recarga: consulta pistas sem parar enquanto versões são publicadas
+typedef struct {
+    PublicacaoBase* publicacao;
+    const char* const* pistas;
+    int nPistas;
+    atomic_int* parar;
+    uint64_t consultas;
+    uint64_t divergencias;
+    uint32_t versoesVistas;
+} ContextoLeitorBase;
+
+/**
+ * @brief Thread leitora do benchmark. Toda versão é publicada com um único peso
+ * em todas as ligações; um peso diferente dentro da mesma versão seria uma leitura rasgada.
+ */
+int executarLeitorBase(void* argumento) {
+    ContextoLeitorBase* leitorBase = (ContextoLeitorBase*) argumento;
+    int leitor = registrarLeitorBase(leitorBase->publicacao);
+    if (leitor < 0) return 1;
+    uint64_t sorteio = (uint64_t) leitor + 1;
+    uint32_t ultima = 0;
+    while (!atomic_load_explicit(leitorBase->parar, memory_order_relaxed)) {
+        uint32_t numero;
+        const BaseEvidencias* base = lerBaseAtual(leitorBase->publicacao, leitor, &numero);
+        if (numero != ultima) leitorBase->versoesVistas++;
+        ultima = numero;
+        float pesoVersao = base->peso[0];
+        for (int i = 0; i < 256; i++) {
+            const char* pista = leitorBase->pistas[proximoAleatorio(&sorteio) % (uint64_t) leitorBase->nPistas];
+            int idPista = buscarNoIndice(&base->pistas, pista);
+            leitorBase->consultas++;
+            if (idPista < 0) continue;
+            for (int l = base->inicio[idPista]; l < base->inicio[idPista + 1]; l++) {
+                leitorBase->divergencias += base->peso[l] != pesoVersao;
+            }
+        }
+    }
+    liberarLeitorBase(leitorBase->publicacao, leitor);
+    return 0;
+}
+#endif
+
+/**
+ * @brief Para a recarga e libera todas as versões (não pode haver leitores ativos).
+ */
+void liberarPublicacaoBase(PublicacaoBase* publicacao) {
+    if (!publicacao) return;
+    pararRecargaBase(publicacao);
+    for (int i = 0; i < MAX_LEITORES_BASE; i++) {
+        atomic_store(&publicacao->leitores[i], 0);
+    }
+    recolherVersoesBase(publicacao);
+    VersaoBase* atual = atomic_load(&publicacao->atual);
+    liberarBaseEvidencias(atual->base);
+    free(atual);
+    free(publicacao);
+}
+
+/**
+ * @brief Modo de linha de comando: ./mestre --exportar-base <arquivo>
+ * Grava as associações do caso no formato aceito por --base.
+ */
+int exportarBaseCaso(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("Uso: %s --exportar-base <arquivo>\n", argv[0]);
+        return 1;
+    }
+    FILE* arquivo = fopen(argv[2], "w");
+    if (!arquivo) {
+        printf("Nao foi possivel criar %s\n", argv[2]);
+        return 1;
+    }
+    fprintf(arquivo, "# pista;suspeito;peso\n");
+    for (int i = 0; i < NUM_ASSOCIACOES_CASO; i++) {
+        fprintf(arquivo, "%s;%s;%.2f\n", ASSOCIACOES_CASO[i].pista, ASSOCIACOES_CASO[i].suspeito, ASSOCIACOES_CASO[i].peso);
+    }
+    return fclose(arquivo) == 0 ? 0 : 1;
+}
+
+// --- Medição de Desempenho ---
+
+/**
+ * @brief Segundos de CPU decorridos desde `inicio`.
+ */
+double segundosDesde(clock_t inicio) {
+    return (double) (clock() - inicio) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Mede os percursos da mansão e da BST em formatos profundos (lista
+ * encadeada de n níveis) e largos (árvores completas/balanceadas).
+ */
+int executarBenchmarks(long n) {
+    if (n < 1) n = 1;
+    if (n > MAX_SALAS_MANSAO) n = MAX_SALAS_MANSAO;
+    printf("Benchmark com %ld nos\n", n);
+
+    // Pistas ordenadas "Pista 00000000", "Pista 00000001", ...
+    char (*nomes)[32] = malloc(sizeof(*nomes) * (size_t) n);
+    const char** ordenadas = (const char**) malloc(sizeof(const char*) * (size_t) n);
+    if (!nomes || !ordenadas) exit(1);
+    for (long i = 0; i < n; i++) {
+        snprintf(nomes[i], sizeof(nomes[i]), "Pista %08ld", i);
+        ordenadas[i] = nomes[i];
+    }
+
+    HashNode* tabelaHash[HASH_SIZE] = { NULL };
+    inserirNaHash(tabelaHash, ordenadas[n / 2], "Mordomo");
+    FILE* descarte = tmpfile();
+    if (!descarte) exit(1);
+
+    // --- Mapa profundo: cada sala só tem saída à esquerda ---
+    clock_t inicio = clock();
+    Sala* raiz = criarSala("Sala", "");
+    Sala* ultima = raiz;
+    for (long i = 1; i < n; i++) {
+        ultima->esquerda = criarSala("Sala", "");
+        ultima = ultima->esquerda;
+    }
+    printf("mapa profundo: construcao %.3fs", segundosDesde(inicio));
+    inicio = clock();
+    liberarMapa(raiz);
+    printf(", liberacao %.3fs\n", segundosDesde(inicio));
+
+    // --- Mapa largo: árvore completa em ordem de nível ---
+    inicio = clock();
+    Sala** salas = (Sala**) malloc(sizeof(Sala*) * (size_t) n);
+    if (!salas) exit(1);
+    for (long i = 0; i < n; i++) {
+        salas[i] = criarSala("Sala", "");
+        if (i > 0) {
+            if (i % 2) salas[(i - 1) / 2]->esquerda = salas[i];
+            else salas[(i - 1) / 2]->direita = salas[i];
+        }
+    }
+    raiz = salas[0];
+    free(salas);
+    printf("mapa largo: construcao %.3fs", segundosDesde(inicio));
+    inicio = clock();
+    liberarMapa(raiz);
+    printf(", liberacao %.3fs\n", segundosDesde(inicio));
+
+    // --- Mansões geradas: tempo de geração e de montagem/liberação da árvore de Salas ---
+    for (int forma = 0; forma < NUM_FORMAS_MANSAO; forma++) {
+        double relogio = relogioParede();
+        MansaoGerada* gerada = gerarMansao((uint32_t) n, forma, 2024, 1000);
+        printf("mansao %s: geracao %.3fs", NOMES_FORMAS_MANSAO[forma], relogioParede() - relogio);
+        inicio = clock();
+        raiz = construirSalasGeradas(gerada);
+        printf(", salas %.3fs", segundosDesde(inicio));
+        inicio = clock();
+        liberarMapa(raiz);
+        printf(", liberacao %.3fs\n", segundosDesde(inicio));
+        liberarMansaoGerada(gerada);
+    }
+
+    // --- Percurso completo: árvore de Salas (ponteiros) x mapa CSR com bitset ---
+    for (int forma = 0; forma < NUM_FORMAS_MANSAO; forma++) {
+        MansaoGerada* gerada = gerarMansao((uint32_t) n, forma, 2024, 1000);
+        raiz = construirSalasGeradas(gerada);
+        Sala** pilha = (Sala**) malloc(sizeof(Sala*) * (size_t) n);
+        if (!pilha) exit(1);
+        inicio = clock();
+        long topo = 0, visitadas = 0;
+        pilha[topo++] = raiz;
+        while (topo > 0) {
+            Sala* sala = pilha[--topo];
+            visitadas++;
+            if (sala->direita) pilha[topo++] = sala->direita;
+            if (sala->esquerda) pilha[topo++] = sala->esquerda;
+        }
+        printf("percurso %s: arvore %.3fs (%ld salas)", NOMES_FORMAS_MANSAO[forma], segundosDesde(inicio), visitadas);
+        free(pilha);
+        liberarMapa(raiz);
+
+        for (uint32_t extras = 0; extras <= (uint32_t) n; extras += (uint32_t) n) {
+            MapaGrafo* mapa = mapaDeMansaoGerada(gerada, extras);
+            uint64_t* bits = criarConjuntoBits(mapa->nSalas);
+            inicio = clock();
+            uint32_t alcancadas = percorrerLargura(mapa, 0, bits);
+            printf(", grafo%s %.3fs (%u salas)", extras ? " com ciclos" : "", segundosDesde(inicio), alcancadas);
+            free(bits);
+            liberarMapaGrafo(mapa);
+        }
+        printf("\n");
+        liberarMansaoGerada(gerada);
+    }
+
+    // --- Consultas de ancestral comum: subida pelos pais x passeio de Euler + sparse table ---
+    for (int forma = 0; forma < NUM_FORMAS_MANSAO; forma++) {
+        MansaoGerada* gerada = gerarMansao((uint32_t) n, forma, 2024, 1000);
+        MapaGrafo* mapa = mapaDeMansaoGerada(gerada, 0);
+        double relogio = relogioParede();
+        IndiceAncestrais* indice = criarIndiceAncestrais(mapa, 0);
+        printf("lca %s: indice %.3fs", NOMES_FORMAS_MANSAO[forma], relogioParede() - relogio);
+
+        // Subida ingênua: iguala as profundidades e sobe os dois lados juntos
+        uint64_t sorteio = 7, somaIngenua = 0, somaIndice = 0, somaDistancias = 0;
+        long nIngenuas = 1000, nConsultas = 1000000;
+        inicio = clock();
+        for (long q = 0; q < nIngenuas; q++) {
+            uint32_t a = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            uint32_t b = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            while (indice->profundidade[a] > indice->profundidade[b]) a = indice->pai[a];
+            while (indice->profundidade[b] > indice->profundidade[a]) b = indice->pai[b];
+            while (a != b) {
+                a = indice->pai[a];
+                b = indice->pai[b];
+            }
+            somaIngenua += a;
+        }
+        double ingenua = segundosDesde(inicio);
+        sorteio = 7;
+        for (long q = 0; q < nIngenuas; q++) {
+            uint32_t a = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            uint32_t b = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            somaIndice += ancestralComum(indice, a, b);
+        }
+        inicio = clock();
+        for (long q = 0; q < nConsultas; q++) {
+            uint32_t a = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            uint32_t b = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            somaDistancias += distanciaSalas(indice, a, b);
+        }
+        printf(", subida %.2fus/consulta, indice %.3fus/consulta (distancia media %.1f%s)\n",
+               ingenua * 1e6 / (double) nIngenuas, segundosDesde(inicio) * 1e6 / (double) nConsultas,
+               (double) somaDistancias / (double) nConsultas, somaIngenua == somaIndice ? "" : ", DIVERGENCIA");
+
+        // Sala no caminho entre a e b: subida ingênua até o ancestral comum x índice.
+        // Metade das salas testadas é um ancestral de `a`, para que "sim" apareça com frequência.
+        uint32_t* consultas = (uint32_t*) malloc(sizeof(uint32_t) * 3 * (size_t) nIngenuas);
+        if (!consultas) exit(1);
+        for (long q = 0; q < nIngenuas; q++) {
+            uint32_t a = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            uint32_t b = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            uint32_t sala = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            if (q & 1) {
+                uint64_t passos = proximoAleatorio(&sorteio) % ((uint64_t) indice->profundidade[a] + 1);
+                for (sala = a; passos > 0; passos--) sala = indice->pai[sala];
+            }
+            consultas[3 * q] = a;
+            consultas[3 * q + 1] = b;
+            consultas[3 * q + 2] = sala;
+        }
+        uint64_t noCaminhoIngenua = 0, noCaminhoIndice = 0;
+        inicio = clock();
+        for (long q = 0; q < nIngenuas; q++) {
+            uint32_t a = consultas[3 * q], b = consultas[3 * q + 1], sala = consultas[3 * q + 2];
+            int achou = a == sala || b == sala;
+            while (indice->profundidade[a] > indice->profundidade[b]) achou |= (a = indice->pai[a]) == sala;
+            while (indice->profundidade[b] > indice->profundidade[a]) achou |= (b = indice->pai[b]) == sala;
+            while (a != b) {
+                a = indice->pai[a];
+                b = indice->pai[b];
+                achou |= a == sala || b == sala;
+            }
+            noCaminhoIngenua += (uint64_t) achou;
+        }
+        ingenua = segundosDesde(inicio);
+        for (long q = 0; q < nIngenuas; q++) {
+            noCaminhoIndice += (uint64_t) estaNoCaminho(indice, consultas[3 * q], consultas[3 * q + 1], consultas[3 * q + 2]);
+        }
+        free(consultas);
+        uint64_t somaNoCaminho = 0;
+        inicio = clock();
+        for (long q = 0; q < nConsultas; q++) {
+            uint32_t a = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            uint32_t b = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            somaNoCaminho += (uint64_t) estaNoCaminho(indice, a, b, (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n));
+        }
+        printf("no caminho %s: subida %.2fus/consulta, indice %.3fus/consulta (%llu de %ld no caminho%s, %llu entre as sorteadas)\n",
+               NOMES_FORMAS_MANSAO[forma], ingenua * 1e6 / (double) nIngenuas,
+               segundosDesde(inicio) * 1e6 / (double) nConsultas, (unsigned long long) noCaminhoIndice, nIngenuas,
+               noCaminhoIngenua == noCaminhoIndice ? "" : ", DIVERGENCIA", (unsigned long long) somaNoCaminho);
+        liberarIndiceAncestrais(indice);
+        liberarMapaGrafo(mapa);
+        liberarMansaoGerada(gerada);
+    }
+
+    // --- Dicas no fim de jogo (1 pista pendente a cada 100 mil salas): busca em largura x motor incremental.
+    // As origens sobem até uma sala com pelo menos 1% da mansão abaixo dela. ---
+    for (int forma = 0; forma < NUM_FORMAS_MANSAO; forma++) {
+        MansaoGerada* gerada = gerarMansao((uint32_t) n, forma, 2024, 1000);
+        MapaGrafo* mapa = mapaDeMansaoGerada(gerada, 0);
+        double relogio = relogioParede();
+        OrdemSalas* ordem = criarOrdemSalas(mapa, 0);
+        printf("dicas %s: ordem %.3fs", NOMES_FORMAS_MANSAO[forma], relogioParede() - relogio);
+        uint64_t* pendentes = criarConjuntoBits(mapa->nSalas);
+        for (uint32_t s = 0; s < mapa->nSalas; s++) {
+            if (aleatorioDoIndice(99, 0, s) % 100000 == 0) marcarBit(pendentes, s);
+        }
+        relogio = relogioParede();
+        MotorDicas* motor = criarMotorDicas(ordem, pendentes);
+        printf(", motor %.3fs", relogioParede() - relogio);
+        uint32_t nOrigens = 4096;
+        uint32_t* origens = (uint32_t*) malloc(sizeof(uint32_t) * nOrigens);
+        if (!origens) exit(1);
+        uint64_t sorteio = 11;
+        for (uint32_t i = 0; i < nOrigens; i++) {
+            uint32_t sala = (uint32_t) (proximoAleatorio(&sorteio) % mapa->nSalas);
+            while (ordem->tamanho[sala] < mapa->nSalas / 100 && ordem->indice->pai[sala] != SEM_SALA) {
+                sala = ordem->indice->pai[sala];
+            }
+            origens[i] = sala;
+        }
+
+        // Busca em largura pelas saídas (só se desce) até a primeira sala pendente
+        uint64_t somaLargura = 0, somaMotor = 0;
+        long nLargura = 20, nConsultas = 100000;
+        uint32_t* fila = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) mapa->nSalas + 1));
+        uint32_t* distanciaFila = (uint32_t*) malloc(sizeof(uint32_t) * ((size_t) mapa->nSalas + 1));
+        uint64_t* vistas = criarConjuntoBits(mapa->nSalas);
+        if (!fila || !distanciaFila) exit(1);
+        inicio = clock();
+        for (long q = 0; q < nLargura; q++) {
+            uint32_t origem = origens[q % nOrigens];
+            memset(vistas, 0, sizeof(uint64_t) * (((size_t) mapa->nSalas + 63) / 64));
+            uint32_t cabecaFila = 0, caudaFila = 0;
+            fila[caudaFila] = origem;
+            distanciaFila[caudaFila++] = 0;
+            marcarBit(vistas, origem);
+            while (cabecaFila < caudaFila) {
+                uint32_t sala = fila[cabecaFila], distancia = distanciaFila[cabecaFila++];
+                if (testarBit(pendentes, sala)) {
+                    somaLargura += distancia;
+                    break;
+                }
+                for (uint32_t s = mapa->inicio[sala]; s < mapa->inicio[sala + 1]; s++) {
+                    uint32_t filho = mapa->destino[s];
+                    if (filho != SEM_SALA && !testarBit(vistas, filho)) {
+                        marcarBit(vistas, filho);
+                        fila[caudaFila] = filho;
+                        distanciaFila[caudaFila++] = distancia + 1;
+                    }
+                }
+            }
+        }
+        double largura = segundosDesde(inicio);
+        for (long q = 0; q < nLargura; q++) {
+            uint32_t distancia = 0;
+            if (pistaMaisProxima(motor, origens[q % nOrigens], &distancia) != SEM_SALA) somaMotor += distancia;
+        }
+        // Consultas intercaladas com coletas (a pista indicada é coletada e depois devolvida)
+        inicio = clock();
+        for (long q = 0; q < nConsultas; q++) {
+            uint32_t alvo = pistaMaisProxima(motor, origens[q % nOrigens], NULL);
+            if (alvo == SEM_SALA) continue;
+            marcarPistaPendente(motor, alvo, 0);
+            marcarPistaPendente(motor, alvo, 1);
+        }
+        printf(", largura %.2fms/dica, motor %.2fus/dica+coleta%s\n", largura * 1e3 / (double) nLargura,
+               segundosDesde(inicio) * 1e6 / (double) nConsultas, somaLargura == somaMotor ? "" : " (DIVERGENCIA)");
+        free(vistas);
+        free(distanciaFila);
+        free(fila);
+        free(origens);
+        free(pendentes);
+        liberarMotorDicas(motor);
+        liberarOrdemSalas(ordem);
+        liberarMapaGrafo(mapa);
+        liberarMansaoGerada(gerada);
+    }
+
+    // --- Árvore sucinta x árvore de Salas (ponteiros): memória, percurso, descidas e subidas ---
+    for (int forma = 0; forma < NUM_FORMAS_MANSAO; forma++) {
+        MansaoGerada* gerada = gerarMansao((uint32_t) n, forma, 2024, 1000);
+        raiz = construirSalasGeradas(gerada);
+        ArvoreSucinta* sucinta = criarArvoreSucinta(gerada, NULL);
+        printf("sucinta %s: Sala %.1fMB, indices %.1fMB, sucinta %.2fMB (%.2f bits/sala)", NOMES_FORMAS_MANSAO[forma],
+               (double) n * sizeof(Sala) / 1e6, (double) n * 2 * sizeof(int32_t) / 1e6,
+               (double) bytesArvoreSucinta(sucinta) / 1e6, 8.0 * (double) bytesArvoreSucinta(sucinta) / (double) n);
+
+        // Percurso completo em profundidade com pilha explícita
+        Sala** pilhaSalas = (Sala**) malloc(sizeof(Sala*) * (size_t) n);
+        uint32_t* pilhaIds = (uint32_t*) malloc(sizeof(uint32_t) * (size_t) n);
+        if (!pilhaSalas || !pilhaIds) exit(1);
+        inicio = clock();
+        long topo = 0, visitadasSalas = 0, visitadasSucinta = 0;
+        pilhaSalas[topo++] = raiz;
+        while (topo > 0) {
+            Sala* sala = pilhaSalas[--topo];
+            visitadasSalas++;
+            if (sala->direita) pilhaSalas[topo++] = sala->direita;
+            if (sala->esquerda) pilhaSalas[topo++] = sala->esquerda;
+        }
+        double percursoSalas = segundosDesde(inicio);
+        inicio = clock();
+        topo = 0;
+        pilhaIds[topo++] = 0;
+        while (topo > 0) {
+            uint32_t sala = pilhaIds[--topo];
+            visitadasSucinta++;
+            uint32_t direita = filhoSucinto(sucinta, sala, 1), esquerda = filhoSucinto(sucinta, sala, 0);
+            if (direita != SEM_SALA) pilhaIds[topo++] = direita;
+            if (esquerda != SEM_SALA) pilhaIds[topo++] = esquerda;
+        }
+        printf(", percurso %.3fs x %.3fs%s", percursoSalas, segundosDesde(inicio),
+               visitadasSalas == visitadasSucinta ? "" : " (DIVERGENCIA)");
+        free(pilhaSalas);
+        free(pilhaIds);
+
+        // Descidas aleatórias (recomeçando no Hall ao chegar a uma folha)
+        long passos = 2000000;
+        uint64_t sorteio = 5;
+        inicio = clock();
+        Sala* salaAtual = raiz;
+        long folhasSalas = 0, folhasSucinta = 0;
+        for (long p = 0; p < passos; p++) {
+            Sala* proxima = (proximoAleatorio(&sorteio) & 1) ? salaAtual->direita : salaAtual->esquerda;
+            if (!proxima) proxima = salaAtual->esquerda ? salaAtual->esquerda : salaAtual->direita;
+            folhasSalas += !proxima;
+            salaAtual = proxima ? proxima : raiz;
+        }
+        double descidaSalas = segundosDesde(inicio);
+        sorteio = 5;
+        inicio = clock();
+        uint32_t idAtual = 0;
+        for (long p = 0; p < passos; p++) {
+            uint32_t proxima = filhoSucinto(sucinta, idAtual, (int) (proximoAleatorio(&sorteio) & 1));
+            if (proxima == SEM_SALA) {
+                proxima = filhoSucinto(sucinta, idAtual, 0);
+                if (proxima == SEM_SALA) proxima = filhoSucinto(sucinta, idAtual, 1);
+            }
+            folhasSucinta += proxima == SEM_SALA;
+            idAtual = proxima != SEM_SALA ? proxima : 0;
+        }
+        double descidaSucinta = segundosDesde(inicio);
+
+        // Subidas até o Hall a partir de salas aleatórias (a Sala não guarda o pai)
+        long subidas = 0;
+        inicio = clock();
+        while (subidas < passos) {
+            uint32_t sala = (uint32_t) (proximoAleatorio(&sorteio) % (uint64_t) n);
+            for (; sala != SEM_SALA && subidas < passos; subidas++) sala = paiSucinto(sucinta, sala);
+        }
+        printf(", descida %.1fns x %.1fns/passo (%ld folhas%s), subida %.1fns/passo\n", descidaSalas * 1e9 / (double) passos,
+               descidaSucinta * 1e9 / (double) passos, folhasSalas, folhasSalas == folhasSucinta ? "" : ", DIVERGENCIA",
+               segundosDesde(inicio) * 1e9 / (double) subidas);
+        liberarArvoreSucinta(sucinta);
+        liberarMapa(raiz);
+        liberarMansaoGerada(gerada);
+    }
+
+    // --- Textos: buffers fixos da Sala x textos em claro x textos compactados ---
+    for (int caso = 0; caso < 2; caso++) {
+        MansaoGerada* gerada = caso ? gerarMansao((uint32_t) n, FORMA_ALEATORIA, 2024, 1000) : NULL;
+        Sala* arvore = NULL;
+        if (!caso) {
+            // Caso com textos longos: n salas com as pistas do jogo em rodízio
+            arvore = criarSala("Hall de Entrada", "");
+            Sala* ultimaSala = arvore;
+            for (long i = 1; i < n; i++) {
+                const AssociacaoPista* associacao = &ASSOCIACOES_CASO[i % NUM_ASSOCIACOES_CASO];
+                char nomeSala[50];
+                snprintf(nomeSala, sizeof(nomeSala), "Corredor do %s %ld", associacao->suspeito, i);
+                ultimaSala->esquerda = criarSala(nomeSala, associacao->pista);
+                ultimaSala = ultimaSala->esquerda;
+            }
+        }
+        MapaGrafo* mapa = caso ? mapaDeMansaoGerada(gerada, 0) : mapaDeArvore(arvore);
+        liberarMapa(arvore);
+        size_t emClaro = tamanhoTextosMapa(mapa);
+        double relogio = relogioParede();
+        size_t bytesCodigos = compactarTextosMapa(mapa);
+        double compactacao = relogioParede() - relogio;
+        size_t decodificados = 0;
+        char texto[TAM_TEXTO_MAPA];
+        relogio = relogioParede();
+        for (int repeticao = 0; repeticao < 3; repeticao++) {
+            for (uint32_t s = 0; s < mapa->nSalas; s++) {
+                decodificados += strlen(textoDoMapa(mapa, mapa->nome[s], texto));
+                if (mapa->pista[s]) decodificados += strlen(textoDoMapa(mapa, mapa->pista[s], texto));
+            }
+        }
+        double decodificacao = relogioParede() - relogio;
+        printf("textos %s: Sala %.1fMB, em claro %.1fMB, compactados %.1fMB + tabela %zuB (%.0f%%), "
+               "compactacao %.3fs, decodificacao %.0fMB/s\n", caso ? "gerados" : "do caso",
+               (double) mapa->nSalas * (sizeof(((Sala*) 0)->nome) + sizeof(((Sala*) 0)->pista)) / 1e6,
+               (double) emClaro / 1e6, (double) bytesCodigos / 1e6, sizeof(TabelaSimbolos),
+               100.0 * (double) bytesCodigos / (double) emClaro, compactacao,
+               decodificacao > 0 ? (double) decodificados / decodificacao / 1e6 : 0.0);
+        liberarMapaGrafo(mapa);
+        liberarMansaoGerada(gerada);
+    }
+
+#ifndef __STDC_NO_THREADS__
+    // --- Recarga da base: leitores consultando enquanto versões novas são publicadas ---
+    {
+        enum { PISTAS_RECARGA = 1000, LEITORES_RECARGA = 4, VERSOES_RECARGA = 200 };
+        static char textosRecarga[PISTAS_RECARGA][2][32];
+        const char* pistasRecarga[PISTAS_RECARGA];
+        AssociacaoPista* associacoes = (AssociacaoPista*) malloc(sizeof(AssociacaoPista) * 2 * PISTAS_RECARGA);
+        if (!associacoes) exit(1);
+        for (int i = 0; i < PISTAS_RECARGA; i++) {
+            snprintf(textosRecarga[i][0], sizeof(textosRecarga[i][0]), "Pista %d", i);
+            snprintf(textosRecarga[i][1], sizeof(textosRecarga[i][1]), "Suspeito_%d", i % 97);
+            pistasRecarga[i] = textosRecarga[i][0];
+            for (int l = 0; l < 2; l++) {
+                associacoes[2 * i + l].pista = textosRecarga[i][0];
+                associacoes[2 * i + l].suspeito = l ? textosRecarga[(i + 1) % PISTAS_RECARGA][1] : textosRecarga[i][1];
+                associacoes[2 * i + l].peso = 1.0f;
+            }
+        }
+        PublicacaoBase* publicacao = criarPublicacaoBase(criarBaseEvidencias(associacoes, 2 * PISTAS_RECARGA));
+        atomic_int pararLeitores;
+        atomic_init(&pararLeitores, 0);
+        thrd_t leitores[LEITORES_RECARGA];
+        ContextoLeitorBase contextos[LEITORES_RECARGA];
+        int nLeitores = 0;
+        double relogio = relogioParede();
+        for (int t = 0; t < LEITORES_RECARGA; t++) {
+            contextos[t] = (ContextoLeitorBase) { publicacao, pistasRecarga, PISTAS_RECARGA, &pararLeitores, 0, 0, 0 };
+            if (thrd_create(&leitores[t], executarLeitorBase, &contextos[t]) == thrd_success) nLeitores++;
+        }
+        // Cada versão usa um único peso em todas as ligações (ver executarLeitorBase)
+        uint32_t maxRetidas = 0;
+        for (int v = 2; v <= VERSOES_RECARGA; v++) {
+            for (int i = 0; i < 2 * PISTAS_RECARGA; i++) associacoes[i].peso = (float) v;
+            publicarBase(publicacao, criarBaseEvidencias(associacoes, 2 * PISTAS_RECARGA));
+            uint32_t retidas = publicacao->versoes - 1 - publicacao->recolhidas;
+            if (retidas > maxRetidas) maxRetidas = retidas;
+        }
+        atomic_store(&pararLeitores, 1);
+        uint64_t consultas = 0, divergencias = 0, versoesVistas = 0;
+        for (int t = 0; t < nLeitores; t++) {
+            thrd_join(leitores[t], NULL);
+            consultas += contextos[t].consultas;
+            divergencias += contextos[t].divergencias;
+            versoesVistas += contextos[t].versoesVistas;
+        }
+        double duracao = relogioParede() - relogio;
+        uint32_t recolhidasDurante = publicacao->recolhidas;
+        recolherVersoesBase(publicacao);
+        printf("recarga da base: %d leitores, %.1fM consultas/s, %u versoes publicadas, %u recolhidas durante a leitura "
+               "(max %u retidas), %.1f versoes vistas por leitor, %u pendentes ao final%s\n", nLeitores,
+               duracao > 0 ? (double) consultas / duracao / 1e6 : 0.0, publicacao->versoes - 1, recolhidasDurante,
+               maxRetidas, nLeitores ? (double) versoesVistas / nLeitores : 0.0,
+               publicacao->versoes - 1 - publicacao->recolhidas, divergencias ? ", LEITURA RASGADA" : "");
+        liberarPublicacaoBase(publicacao);
+        free(associacoes);
+    }
+#endif
+
+    // --- BSTs de pistas: degenerada (tudo à direita) e balanceada ---
+    for (int forma = 0; forma < 2; forma++) {
+        inicio = clock();
+        PistaNode* bst = NULL;
+        if (forma == 0) {
+            PistaNode** ligacao = &bst;
+            for (long i = 0; i < n; i++) {
+                PistaNode* node = (PistaNode*) calloc(1, sizeof(PistaNode));
+                if (!node) exit(1);
+                strcpy(node->pista, ordenadas[i]);
+                *ligacao = node;
+                ligacao = &node->direita;
+            }
+        } else {
+            bst = construirPistasBalanceadas(ordenadas, (int) n);
+        }
+        printf("pistas %s: construcao %.3fs", forma == 0 ? "profundas" : "balanceadas", segundosDesde(inicio));
+
+        inicio = clock();
+        int total = contarPistas(bst);
+        printf(", contagem %.3fs", segundosDesde(inicio));
+
+        inicio = clock();
+        int doSuspeito = contarPistasParaSuspeito(bst, tabelaHash, "Mordomo");
+        printf(", por suspeito %.3fs", segundosDesde(inicio));
+
+        inicio = clock();
+        escreverPistas(descarte, bst);
+        printf(", escrita %.3fs", segundosDesde(inicio));
+
+        inicio = clock();
+        liberarPistas(bst);
+        printf(", liberacao %.3fs (%d pistas, %d do suspeito)\n", segundosDesde(inicio), total, doSuspeito);
+    }
+
+    // --- Inserção iterativa em ordem crescente (pior caso da BST) ---
+    long nInsercao = n < 10000 ? n : 10000;
+    inicio = clock();
+    PistaNode* bst = NULL;
+    for (long i = 0; i < nInsercao; i++) {
+        bst = adicionarPista(bst, ordenadas[i]);
+    }
+    printf("insercao degenerada de %ld pistas: %.3fs\n", nInsercao, segundosDesde(inicio));
+    liberarPistas(bst);
+
+    // --- Ranking ponderado: 100 mil suspeitos, cada pista ligada a 1-3 deles ---
+    int nSuspeitos = 100000;
+    char (*suspeitos)[24] = malloc(sizeof(*suspeitos) * (size_t) nSuspeitos);
+    AssociacaoPista* associacoes = (AssociacaoPista*) malloc(sizeof(AssociacaoPista) * (size_t) n * 3);
+    if (!suspeitos || !associacoes) exit(1);
+    for (int s = 0; s < nSuspeitos; s++) {
+        snprintf(suspeitos[s], sizeof(suspeitos[s]), "Suspeito %d", s);
+    }
+    uint64_t semente = 42;
+    int nAssociacoes = 0;
+    for (long i = 0; i < n; i++) {
+        int ligacoes = 1 + (int) (proximoAleatorio(&semente) % 3);
+        for (int l = 0; l < ligacoes; l++) {
+            associacoes[nAssociacoes].pista = ordenadas[i];
+            associacoes[nAssociacoes].suspeito = suspeitos[proximoAleatorio(&semente) % (uint64_t) nSuspeitos];
+            associacoes[nAssociacoes].peso = (float) (proximoAleatorio(&semente) % 100) / 10.0f;
+            nAssociacoes++;
+        }
+    }
+    inicio = clock();
+    BaseEvidencias* base = criarBaseEvidencias(associacoes, nAssociacoes);
+    printf("base CSR: %d ligacoes, construcao %.3fs", nAssociacoes, segundosDesde(inicio));
+    RankingSuspeitos* ranking = criarRanking(base, TOP_K_SUSPEITOS);
+    inicio = clock();
+    for (long i = 0; i < n; i++) {
+        registrarEvidencia(ranking, ordenadas[i]);
+    }
+    printf(", registro de %ld pistas %.3fs\n", n, segundosDesde(inicio));
+    exibirRanking(ranking);
+    liberarRanking(ranking);
+    liberarBaseEvidencias(base);
+    free(associacoes);
+    free(suspeitos);
+
+    fclose(descarte);
+    liberarHash(tabelaHash);
+    free(ordenadas);
+    free(nomes);
+    return 0;
+}
@@ -190,25 +190,31 @@ void explorarSalas(Sala* salaAtual) {
 }
 
 /**
- * @brief Libera recursivamente toda a memória alocada para o mapa.
+ * @brief Libera toda a memória alocada para o mapa, sem recursão.
  *
  * Para evitar vazamento de memória (memory leak), esta função percorre
- * a árvore e libera cada um dos nós alocados com malloc. A abordagem é
- * "pós-ordem": primeiro libera os filhos (esquerda, direita) e depois o
- * próprio nó.
+ * a árvore e libera cada um dos nós alocados com malloc. Em vez de
+ * recursão (que estoura a pilha em mapas muito profundos), ela usa
+ * rotações: enquanto a sala atual tiver um filho à esquerda, esse filho
+ * "sobe" e a sala atual passa a ser o seu filho da direita. Quando não
+ * há mais nada à esquerda, a sala é liberada e seguimos pela direita.
+ * O custo total é linear e a memória extra é constante.
  *
- * @param sala O nó atual a ser liberado.
+ * @param sala A raiz do mapa a ser liberado.
  */
 void liberarMapa(Sala* sala) {
-    // Condição de parada da recursão: se a sala não existe, não há nada a fazer.
-    if (sala == NULL) {
-        return;
+    while (sala != NULL) {
+        if (sala->esquerda != NULL) {
+            // Rotação à direita: o filho esquerdo passa a ser a raiz
+            Sala* esquerda = sala->esquerda;
+            sala->esquerda = esquerda->direita;
+            esquerda->direita = sala;
+            sala = esquerda;
+        } else {
+            // Sem sub-árvore esquerda: libera a sala e segue pela direita
+            Sala* direita = sala->direita;
+            free(sala);
+            sala = direita;
+        }
     }
-
-    // Libera recursivamente a sub-árvore da esquerda
-    liberarMapa(sala->esquerda);
-    // Libera recursivamente a sub-árvore da direita
-    liberarMapa(sala->direita);
-    // Finalmente, libera a sala atual
-    free(sala);
 }
\ No newline at end of file